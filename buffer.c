@@ -3,44 +3,151 @@
  */
 #include "buffer.h"
 
-Buffer* buffer_create(int capacity)
+/**
+ * Returns true if task @p a should be removed before task @p b when ordered by
+ * earliest deadline.
+ */
+static bool runsBefore(const Task* const a, const Task* const b)
+{
+    return a->deadlineNs < b->deadlineNs ||
+           (a->deadlineNs == b->deadlineNs && a->seq < b->seq);
+}
+
+/**
+ * Adds a task to the heap of occupied slots, sifting it up into place.
+ */
+static void heapPush(Buffer* buffer, const Task* const task)
+{
+    int i = buffer->occupied;
+    while (i > 0 && runsBefore(task, &buffer->tasks[(i - 1) / 2]))
+    {
+        buffer->tasks[i] = buffer->tasks[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    buffer->tasks[i] = *task;
+}
+
+/**
+ * Removes the task at the top of the heap of occupied slots, sifting the last
+ * one down into its place.
+ */
+static void heapPop(Buffer* buffer, Task* task)
+{
+    const int size = buffer->occupied - 1;
+    const Task last = buffer->tasks[size];
+    int i = 0;
+
+    *task = buffer->tasks[0];
+    while (2 * i + 1 < size)
+    {
+        int child = 2 * i + 1;
+        if (child + 1 < size && runsBefore(&buffer->tasks[child + 1], &buffer->tasks[child]))
+        {
+            child++;
+        }
+        if (!runsBefore(&buffer->tasks[child], &last))
+        {
+            break;
+        }
+        buffer->tasks[i] = buffer->tasks[child];
+        i = child;
+    }
+    buffer->tasks[i] = last;
+}
+
+/**
+ * Returns the size of a Buffer holding 'capacity' tasks, rounded up to a whole
+ * number of cache lines as aligned_alloc requires.
+ */
+static size_t bufferSize(int capacity)
+{
+    size_t size = sizeof(Buffer) + sizeof(Task) * (size_t) capacity;
+    return (size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+}
+
+/**
+ * Initialises a newly allocated Buffer, making its mutex and conditions usable
+ * between processes if it is in shared memory.
+ */
+static Buffer* initBuffer(Buffer* buffer, int capacity, BufferOrder order, bool shared)
 {
-    Buffer* buffer = (Buffer*) malloc(sizeof(Buffer));
-    buffer->tasks = (Task**) malloc(sizeof(Task*) * capacity);
     buffer->capacity = capacity;
+    buffer->order = order;
+    buffer->shared = shared;
     buffer->occupied = 0;
     buffer->in = 0;
+    buffer->limit = capacity;
     buffer->out = 0;
-    pthread_mutex_init(&buffer->mutex, NULL);
-    pthread_cond_init(&buffer->fullCond, NULL);
-    pthread_cond_init(&buffer->emptyCond, NULL);
+    buffer->closed = false;
+    sharedMem_initMutex(&buffer->mutex, shared);
+    sharedMem_initCond(&buffer->fullCond, shared);
+    sharedMem_initCond(&buffer->emptyCond, shared);
 
     return buffer;
 }
 
+Buffer* buffer_create(int capacity, BufferOrder order)
+{
+    Buffer* buffer = (Buffer*) aligned_alloc(CACHE_LINE_SIZE, bufferSize(capacity));
+    return initBuffer(buffer, capacity, order, false);
+}
+
+Buffer* buffer_createShared(int capacity, BufferOrder order)
+{
+    Buffer* buffer = (Buffer*) sharedMem_alloc(bufferSize(capacity));
+    return buffer != NULL ? initBuffer(buffer, capacity, order, true) : NULL;
+}
+
 void buffer_free(Buffer* buffer)
 {
-    free(buffer->tasks);
     pthread_mutex_destroy(&buffer->mutex);
-    pthread_cond_destroy(&buffer->fullCond);
-    pthread_cond_destroy(&buffer->emptyCond);
-    free(buffer);
+    if (buffer->shared)
+    {
+        //DESTROYING A CONDITION WAITS FOR EVERY WAITER THAT WAS WOKEN TO RETURN,
+        // WHICH ONE IN A PROCESS THAT DIED NEVER WILL, SO IT IS ONLY UNMAPPED
+        sharedMem_free(buffer);
+    }
+    else
+    {
+        pthread_cond_destroy(&buffer->fullCond);
+        pthread_cond_destroy(&buffer->emptyCond);
+        free(buffer);
+    }
 }
 
-void buffer_insertNext(Buffer* buffer, Task* task)
+void buffer_insertNext(Buffer* buffer, const Task* const task)
 {
-    buffer->tasks[buffer->in++] = task;
-    buffer->in %= buffer->capacity;
+    if (buffer->order == BUFFER_EDF)
+    {
+        heapPush(buffer, task);
+    }
+    else
+    {
+        buffer->tasks[buffer->in++] = *task;
+        buffer->in %= buffer->capacity;
+    }
     (buffer->occupied)++;
 }
 
-Task* buffer_removeNext(Buffer* buffer)
+bool buffer_removeNext(Buffer* buffer, Task* task)
 {
-    Task* task = buffer->tasks[buffer->out++];
-    buffer->out %= buffer->capacity;
+    if (buffer_isEmpty(buffer))
+    {
+        return false;
+    }
+
+    if (buffer->order == BUFFER_EDF)
+    {
+        heapPop(buffer, task);
+    }
+    else
+    {
+        *task = buffer->tasks[buffer->out++];
+        buffer->out %= buffer->capacity;
+    }
     (buffer->occupied)--;
 
-    return task;
+    return true;
 }
 
 bool buffer_isEmpty(const Buffer* const buffer)
@@ -50,5 +157,22 @@ bool buffer_isEmpty(const Buffer* const buffer)
 
 int buffer_numOfEmptySpaces(const Buffer* const buffer)
 {
-    return buffer->capacity - buffer->occupied;
+    return buffer->limit > buffer->occupied ? buffer->limit - buffer->occupied : 0;
+}
+
+void buffer_setLimit(Buffer* buffer, int limit)
+{
+    buffer->limit = limit < 1 ? 1 : (limit > buffer->capacity ? buffer->capacity : limit);
+}
+
+void buffer_close(Buffer* buffer)
+{
+    buffer->closed = true;
+    pthread_cond_broadcast(&buffer->fullCond);
+    pthread_cond_broadcast(&buffer->emptyCond);
+}
+
+bool buffer_isDrained(const Buffer* const buffer)
+{
+    return buffer->closed && buffer_isEmpty(buffer);
 }
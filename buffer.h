@@ -11,6 +11,38 @@
 #include <pthread.h>
 #include <stdbool.h>
 #include "task.h"
+#include "sharedMem.h"
+
+//CONSTANTS
+/**
+ * The size of a cache line in bytes. The groups of fields in a Buffer are kept
+ * on separate lines of this size so they do not bounce between cores.
+ */
+#define CACHE_LINE_SIZE 64
+
+/**
+ * Starts a group of fields in a Buffer on its own cache line. Building with
+ * BUFFER_PACKED defined packs the fields together instead, so that the two
+ * layouts can be compared with bufferBench.
+ */
+#ifdef BUFFER_PACKED
+#define BUFFER_LINE
+#else
+#define BUFFER_LINE _Alignas(CACHE_LINE_SIZE)
+#endif
+
+/**
+ * @brief The order tasks are removed from a Buffer in.
+ *
+ * @c BUFFER_FIFO removes tasks in the order they were inserted. @c BUFFER_EDF
+ * removes the task with the earliest deadline first, tasks without a deadline
+ * coming after every task with one, and ties in the order they were inserted.
+ */
+typedef enum
+{
+    BUFFER_FIFO,
+    BUFFER_EDF
+} BufferOrder;
 
 //STRUCTS
 /**
@@ -18,33 +50,67 @@
  *
  * This Buffer struct is shared between multiple threads and therefore needs a
  * mutual exclusion lock. The buffer is a circular queue wrapped over an array,
- * hence it keeps track of the head and tail of the queue. The buffer is
- * configured to store Task struct pointers, hence it is used for the scheduling
- * of tasks. It also uses pthread conditions to let the other threads know when
- * they can successfully perform their tasks. More details are in the scheduler.h
- * documentation.
- *
- * @field tasks The queue of task structs ready to be executed by the CPU threads.
- * @field capacity How many tasks the buffer can hold at once.
+ * hence it keeps track of the head and tail of the queue. When ordered by
+ * earliest deadline the array is instead kept as a binary min-heap of the
+ * @c occupied tasks, and the head and tail are unused. The buffer stores
+ * Task structs by value in an array allocated along with the struct itself, so
+ * that handing a task over is a single copy into or out of a slot. It also uses
+ * pthread conditions to let the other threads know when they can successfully
+ * perform their tasks. More details are in the scheduler.h documentation.
+ *  The fields are grouped by which side uses them. The lock and the state both
+ * sides update while holding it share one cache line. The producer's tail and
+ * limit get another, along with the condition the producer waits on, and the
+ * consumers' head another, along with the condition the CPU threads wait on.
+ * Every index is still only changed while holding the lock, and each condition
+ * is signalled by the other side, so the groups do not stop the lines moving
+ * between cores altogether. They keep an insertion from invalidating the
+ * line a consumer has just read the head from, and the producer's waits from
+ * invalidating the line the consumers wait on, and the other way around.
+ *
+ * @field capacity How many tasks the buffer has room for.
+ * @field order The order tasks are removed from the buffer in.
+ * @field shared True if the buffer is in shared memory, where it can be used by
+ * several processes.
+ * @field mutex The lock that ensures mutual exclusion on threads accessing the
+ * buffer.
  * @field occupied How many spaces in the buffer have a task in them.
+ * @field closed True once the producer has stated that no more tasks will be
+ * inserted. The CPU threads drain what remains and then stop.
  * @field in The index of the next task to be inserted i.e. the tail of the buffer.
+ * @field limit How many tasks the producer lets the buffer hold at once, up to
+ * @c capacity. Only the producer reads or changes it, so it can be tuned while
+ * the buffer is in use.
+ * @field emptyCond The condition that lets the task thread know that there is
+ * at least one empty space in the buffer for a task to be inserted in to.
  * @field out The index of the next task to be removed i.e. the head of the buffer.
- * @field mutex The lock that ensures mutual exclusion on threads accessing the
- * buffer.
  * @field fullCond The condition that lets the CPU threads know that there is a
  * task in the buffer ready to be processed.
- * @field emptyCond The condition that lets the task thread know that there is
- * at least one empty space in the buffer for a task to be inserted in to.
+ * @field tasks The queue of tasks ready to be executed by the CPU threads.
  */
 typedef struct
 {
-    Task** tasks;
+    //READ ONLY AFTER CREATION
     int capacity;
+    BufferOrder order;
+    bool shared;
+
+    //THE LOCK, AND THE STATE BOTH SIDES UPDATE WHILE HOLDING IT
+    BUFFER_LINE pthread_mutex_t mutex;
     int occupied;
-    int in, out;
-    pthread_mutex_t mutex;
-    pthread_cond_t fullCond;
+    bool closed;
+
+    //USED TO INSERT: THE TAIL, THE LIMIT, AND THE CONDITION THE PRODUCER WAITS
+    // ON FOR THE CONSUMERS TO SIGNAL
+    BUFFER_LINE int in;
+    int limit;
     pthread_cond_t emptyCond;
+
+    //USED TO REMOVE: THE HEAD, AND THE CONDITION THE CONSUMERS WAIT ON FOR THE
+    // PRODUCER TO BROADCAST
+    BUFFER_LINE int out;
+    pthread_cond_t fullCond;
+
+    BUFFER_LINE Task tasks[];
 } Buffer;
 
 //FUNCTION PROTOTYPES
@@ -52,21 +118,38 @@ typedef struct
  * @brief Creates a Buffer of size 'capacity; and allocates memory to it on the
  * heap.
  *
- * This function allocates memory to the overall struct and the array of tasks
- * inside. The size of the buffer is set to the imported capacity. Number of 
+ * This function allocates one cache line aligned block holding both the struct
+ * and the array of tasks inside. The size of the buffer is set to the imported capacity. Number of 
  * occupied is initialized to 0, as well as the head and tail indices. The mutex
- * and pthread conditions are also initialized.
+ * and pthread conditions are also initialized. The buffer starts open, with
+ * its limit set to its capacity.
  *
  * @param capacity The maximum number of tasks the buffer can hold.
+ * @param order The order tasks are removed from the buffer in.
  * @return A pointer to the Buffer struct on the heap.
  */
-Buffer* buffer_create(int capacity);
+Buffer* buffer_create(int capacity, BufferOrder order);
+
+/**
+ * @brief Creates a Buffer of size 'capacity' in shared memory.
+ *
+ * The same as buffer_create(), except that the buffer is allocated with
+ * sharedMem_alloc() and its mutex and conditions are process-shared, so a
+ * process forked afterwards can insert and remove tasks. Tasks are still copied
+ * straight into and out of the slots, with nothing else passed between the
+ * processes.
+ *
+ * @param capacity The maximum number of tasks the buffer can hold.
+ * @param order The order tasks are removed from the buffer in.
+ * @return A pointer to the Buffer struct in shared memory, or NULL on an error.
+ */
+Buffer* buffer_createShared(int capacity, BufferOrder order);
 
 /**
  * @brief Deallocates all memory associated with the specified Buffer.
  *
- * Free's the array of tasks inside the buffer and destroys the pthread mutex and
- * conditions. Then frees the overall struct.
+ * Destroys the pthread mutex and conditions. Then frees the overall struct,
+ * which includes the array of tasks, or unmaps it if it is in shared memory.
  *
  * @param buffer The Buffer to deallocate from memory.
  */
@@ -75,27 +158,33 @@ void buffer_free(Buffer* buffer);
 /**
  * @brief Inserts a task struct into the next available spot in the buffer.
  * 
- * This function inserts a task at the index @c in. @c in is then incremented to
+ * This function copies a task into the slot at the index @c in. @c in is then incremented to
  * be ready for the next insertion, @c is also wrapped around to the start of the
  * array if it goes past then end of the buffer. The number of occupied spots is
- * also incremented.
+ * also incremented. When ordered by earliest deadline the task is instead
+ * sifted into its place in the heap.
  * 
  * @param buffer The buffer to insert the task in to.
- * @param task The task to be inserted.
+ * @param task The task to be copied into the buffer.
  */
-void buffer_insertNext(Buffer* buffer, Task* task);
+void buffer_insertNext(Buffer* buffer, const Task* const task);
 
 /**
  * @brief Removes the next task from the buffer to be executed.
  *
- * This functions removes the task at the index @c out, which is then decremented.
- * If @c out is not in the array bounds, it is wrapped around to the end of the
- * buffer. The number of occupied spots is also decremented.
+ * This functions copies the task at the index @c out into @p task, @c out is
+ * then incremented. If @c out is not in the array bounds, it is wrapped around
+ * to the start of the buffer. The number of occupied spots is also decremented.
+ * When ordered by earliest deadline the task at the top of the heap is removed
+ * instead. If the buffer is empty nothing is removed and false is returned. Once the
+ * buffer has been closed, false is the end-of-stream result telling the caller
+ * that no more tasks will ever arrive.
  *
  * @param buffer The buffer to remove the next task from.
- * @return The task that was removed from the buffer.
+ * @param task Where to copy the removed task to.
+ * @return True if a task was removed, false if the buffer is empty.
  */
-Task* buffer_removeNext(Buffer* buffer);
+bool buffer_removeNext(Buffer* buffer, Task* task);
 
 /**
  * @brief Returns true if there are no tasks currently in the buffer.
@@ -110,12 +199,50 @@ bool buffer_isEmpty(const Buffer* const buffer);
 /**
  * @brief Returns the number of spots that are not occupied in the buffer.
  *
- * The number of spots that are not occupied is equal to the capacity of the
- * buffer minus the number of occupied spots.
+ * The number of spots that are not occupied is equal to the limit of the
+ * buffer minus the number of occupied spots, or 0 if the limit has been
+ * lowered below the number of occupied spots.
  *
  * @param buffer The buffer to calculate the number of empty spots in.
  * @return The number of spots that are not occupied in the given buffer.
  */
 int buffer_numOfEmptySpaces(const Buffer* const buffer);
 
+/**
+ * @brief Sets how many tasks the producer lets the buffer hold at once.
+ *
+ * Must only be called by the producer. The limit is kept between 1 and the
+ * capacity of the buffer. Lowering it below the number of occupied spots
+ * removes nothing, the producer just waits until enough tasks are removed.
+ *
+ * @param buffer The buffer to set the limit of.
+ * @param limit The number of tasks the buffer may hold.
+ */
+void buffer_setLimit(Buffer* buffer, int limit);
+
+/**
+ * @brief Marks the buffer as closed, meaning no more tasks will be inserted.
+ *
+ * The caller must hold the buffer's mutex. Every thread waiting on
+ * @c fullCond is woken so that it can see the buffer has been closed and, once
+ * the remaining tasks have been drained, stop waiting for more. Every thread
+ * waiting on @c emptyCond is woken too, as a buffer is only closed with a
+ * thread still inserting if whatever would have made room has died.
+ *
+ * @param buffer The buffer to close.
+ */
+void buffer_close(Buffer* buffer);
+
+/**
+ * @brief Returns true if there is nothing left to wait for in the buffer.
+ *
+ * A buffer is drained once it has been closed and every task inserted before
+ * closing has been removed. A consumer waiting for a task should stop waiting
+ * when this becomes true.
+ *
+ * @param buffer The buffer to check.
+ * @return True if the buffer is closed and empty.
+ */
+bool buffer_isDrained(const Buffer* const buffer);
+
 #endif
@@ -0,0 +1,395 @@
+/**
+ * See documentation in the header file.
+ */
+#include "bufferBench.h"
+
+int main(int argc, char* argv[])
+{
+    const char* capacityList = DEFAULT_CAPACITIES;
+    const char* batchList = DEFAULT_BATCHES;
+    const char* orderName = "fifo";
+    int numProducers = DEFAULT_THREADS, numConsumers = DEFAULT_THREADS;
+    int numTasks = DEFAULT_TASKS;
+    bool multiProcess = false;
+    int option;
+    while ((option = getopt(argc, argv, "p:c:n:s:b:o:P")) != -1)
+    {
+        switch (option)
+        {
+            case 'p':
+                if ((numProducers = parseCount(optarg, "Number of producers", MAX_THREADS)) == -1)
+                {
+                    return -1;
+                }
+                break;
+            case 'c':
+                if ((numConsumers = parseCount(optarg, "Number of consumers", MAX_THREADS)) == -1)
+                {
+                    return -1;
+                }
+                break;
+            case 'n':
+                if ((numTasks = parseCount(optarg, "Number of tasks", MAX_LIST_VALUE * 10)) == -1)
+                {
+                    return -1;
+                }
+                break;
+            case 's':
+                capacityList = optarg;
+                break;
+            case 'b':
+                batchList = optarg;
+                break;
+            case 'o':
+                orderName = optarg;
+                break;
+            case 'P':
+                multiProcess = true;
+                break;
+            default:
+                printUsage();
+                return -1;
+        }
+    }
+    if (optind != argc)
+    {
+        printUsage();
+        return -1;
+    }
+
+    int capacities[MAX_LIST_SIZE], batches[MAX_LIST_SIZE];
+    const int numCapacities = parseList(capacityList, "Capacity", capacities);
+    const int numBatches = parseList(batchList, "Batch size", batches);
+    if (numCapacities == -1 || numBatches == -1)
+    {
+        return -1;
+    }
+    BufferOrder order;
+    if (strcmp(orderName, "fifo") == 0)
+    {
+        order = BUFFER_FIFO;
+    }
+    else if (strcmp(orderName, "edf") == 0)
+    {
+        order = BUFFER_EDF;
+    }
+    else
+    {
+        fprintf(stderr, "ERROR: Queue order '%s' is not one of: fifo edf\n", orderName);
+        return -1;
+    }
+
+#ifdef BUFFER_PACKED
+    const char* layout = "packed";
+#else
+    const char* layout = "padded";
+#endif
+    printf("%d producer and %d consumer %s, %d tasks each, %s order, %s layout\n", numProducers,
+           numConsumers, multiProcess ? "processes" : "threads", numTasks, orderName, layout);
+    printf("%10s %8s %12s %14s %8s\n", "Capacity", "Batch", "ns/task", "tasks/s", "Result");
+
+    //EVERYTHING THE PRODUCERS AND CONSUMERS SHARE IS IN SHARED MEMORY WHEN
+    // THEY ARE PROCESSES
+    BenchRun* run = multiProcess ? sharedMem_alloc(sizeof(BenchRun)) : malloc(sizeof(BenchRun));
+    if (run == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+
+    //RUN EVERY COMBINATION OF CAPACITY AND BATCH SIZE, ONE AT A TIME SO THAT
+    // THEY DO NOT COMPETE FOR CORES
+    int totalFailures = 0;
+    for (int i = 0; i < numCapacities * numBatches; i++)
+    {
+        const int capacity = capacities[i / numBatches];
+        run->buffer = multiProcess ? buffer_createShared(capacity, order) :
+                      buffer_create(capacity, order);
+        if (run->buffer == NULL)
+        {
+            totalFailures++;
+            break;
+        }
+        run->numProducers = numProducers;
+        run->numConsumers = numConsumers;
+        run->numTasks = numTasks;
+        run->batch = batches[i % numBatches];
+        run->multiProcess = multiProcess;
+
+        long long elapsedNs;
+        const int failures = runBench(run, &elapsedNs);
+        const long long totalTasks = (long long) numProducers * numTasks;
+        printf("%10d %8d %12.1f %14.0f %8s\n", capacity, run->batch,
+               (double) elapsedNs / totalTasks, totalTasks / (elapsedNs / 1e9),
+               failures == 0 ? "ok" : "FAILED");
+        fflush(stdout);
+
+        totalFailures += failures;
+        buffer_free(run->buffer);
+    }
+    if (multiProcess)
+    {
+        sharedMem_free(run);
+    }
+    else
+    {
+        free(run);
+    }
+
+    return totalFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int runBench(BenchRun* run, long long* elapsedNs)
+{
+    const long long totalTasks = (long long) run->numProducers * run->numTasks;
+    run->producersLeft = run->numProducers;
+    run->timesRemoved = run->multiProcess ? sharedMem_alloc(sizeof(atomic_uchar) * totalTasks) :
+                        malloc(sizeof(atomic_uchar) * totalTasks);
+    if (run->timesRemoved == NULL)
+    {
+        *elapsedNs = 0;
+        return 1;
+    }
+    for (long long i = 0; i < totalTasks; i++)
+    {
+        atomic_init(&run->timesRemoved[i], 0);
+    }
+    atomic_init(&run->outOfOrder, 0);
+
+    const int numThreads = run->numProducers + run->numConsumers;
+    pthread_t* threads = malloc(sizeof(pthread_t) * numThreads);
+    pid_t* pids = malloc(sizeof(pid_t) * numThreads);
+    BenchArgs* args = malloc(sizeof(BenchArgs) * numThreads);
+    int failures = 0;
+
+    //START THE CONSUMERS FIRST SO THE PRODUCERS NEVER FIND NOBODY TO WAKE
+    fflush(NULL);
+    const long long startNs = getTimeNanos();
+    int numStarted = 0;
+    for (; numStarted < numThreads; numStarted++)
+    {
+        const int i = numStarted;
+        const bool isProducer = i >= run->numConsumers;
+        void* (*function)(void*) = isProducer ? producer : consumer;
+        args[i].run = run;
+        args[i].threadID = isProducer ? i - run->numConsumers : i;
+        if (!run->multiProcess)
+        {
+            pthread_create(&threads[i], NULL, function, &args[i]);
+        }
+        else if ((pids[i] = fork()) == 0)
+        {
+            function(&args[i]);
+            _exit(EXIT_SUCCESS);
+        }
+        else if (pids[i] == -1)
+        {
+            perror("ERROR: A producer or consumer process could not be created ");
+            break;
+        }
+    }
+
+    //WITHOUT EVERY PROCESS THE OTHERS MAY NEVER FINISH, SO STOP THEM
+    if (numStarted < numThreads)
+    {
+        for (int i = 0; i < numStarted; i++)
+        {
+            kill(pids[i], SIGKILL);
+        }
+        failures++;
+    }
+    for (int i = 0; i < numStarted; i++)
+    {
+        int status = 0;
+        if (!run->multiProcess)
+        {
+            pthread_join(threads[i], NULL);
+        }
+        else if (waitpid(pids[i], &status, 0) == -1 || status != 0)
+        {
+            fprintf(stderr, "ERROR: A producer or consumer process failed.\n");
+            failures++;
+        }
+    }
+    *elapsedNs = getTimeNanos() - startNs;
+
+    //EVERY TASK MUST HAVE BEEN REMOVED EXACTLY ONCE
+    long long numLost = 0, numDuplicated = 0;
+    for (long long i = 0; i < totalTasks; i++)
+    {
+        const int times = atomic_load(&run->timesRemoved[i]);
+        numLost += times == 0;
+        numDuplicated += times > 1;
+    }
+    if (numLost > 0 || numDuplicated > 0)
+    {
+        fprintf(stderr, "ERROR: %lld tasks were never removed and %lld were removed "
+                "more than once.\n", numLost, numDuplicated);
+        failures++;
+    }
+    if (atomic_load(&run->outOfOrder) > 0)
+    {
+        fprintf(stderr, "ERROR: %d tasks were removed before an earlier task of the "
+                "same producer.\n", atomic_load(&run->outOfOrder));
+        failures++;
+    }
+    if (!buffer_isDrained(run->buffer) ||
+        buffer_numOfEmptySpaces(run->buffer) != run->buffer->capacity)
+    {
+        fprintf(stderr, "ERROR: The buffer was not left closed and empty.\n");
+        failures++;
+    }
+
+    free(threads);
+    free(pids);
+    free(args);
+    if (run->multiProcess)
+    {
+        sharedMem_free(run->timesRemoved);
+    }
+    else
+    {
+        free(run->timesRemoved);
+    }
+    return failures;
+}
+
+void* producer(void* args)
+{
+    BenchRun* run = ((BenchArgs*) args)->run;
+    const int producerID = ((BenchArgs*) args)->threadID;
+    Buffer* buffer = run->buffer;
+
+    int seq = 0;
+    while (seq < run->numTasks)
+    {
+        pthread_mutex_lock(&buffer->mutex);
+        while (buffer_numOfEmptySpaces(buffer) == 0)
+        {
+            pthread_cond_wait(&buffer->emptyCond, &buffer->mutex);
+        }
+
+        //INSERT AS MANY OF THE BATCH AS THERE IS ROOM FOR
+        int numInserted = 0;
+        while (numInserted < run->batch && seq < run->numTasks &&
+               buffer_numOfEmptySpaces(buffer) > 0)
+        {
+            Task task;
+            task_init(&task, producerID, 1, 0, seq);
+            //IN EDF ORDER EACH PRODUCER'S TASKS ARE DUE ONE AFTER ANOTHER
+            task.deadlineNs = seq;
+            buffer_insertNext(buffer, &task);
+            numInserted++;
+            seq++;
+        }
+
+        //THE LAST PRODUCER TO FINISH CLOSES THE BUFFER
+        if (seq == run->numTasks && --run->producersLeft == 0)
+        {
+            buffer_close(buffer);
+        }
+        pthread_mutex_unlock(&buffer->mutex);
+        pthread_cond_broadcast(&buffer->fullCond);
+    }
+
+    return NULL;
+}
+
+void* consumer(void* args)
+{
+    BenchRun* run = ((BenchArgs*) args)->run;
+    Buffer* buffer = run->buffer;
+    Task* tasks = malloc(sizeof(Task) * run->batch);
+
+    //THE LAST SEQUENCE NUMBER THIS CONSUMER REMOVED FROM EACH PRODUCER
+    int* lastSeq = malloc(sizeof(int) * run->numProducers);
+    for (int i = 0; i < run->numProducers; i++)
+    {
+        lastSeq[i] = -1;
+    }
+
+    while (true)
+    {
+        pthread_mutex_lock(&buffer->mutex);
+        while (buffer_isEmpty(buffer) && !buffer_isDrained(buffer))
+        {
+            pthread_cond_wait(&buffer->fullCond, &buffer->mutex);
+        }
+
+        //REMOVE UP TO A BATCH, THEN CHECK THEM OUTSIDE OF THE LOCK
+        int numRemoved = 0;
+        while (numRemoved < run->batch && buffer_removeNext(buffer, &tasks[numRemoved]))
+        {
+            numRemoved++;
+        }
+        pthread_mutex_unlock(&buffer->mutex);
+        pthread_cond_broadcast(&buffer->emptyCond);
+
+        if (numRemoved == 0)
+        {
+            break;
+        }
+        for (int i = 0; i < numRemoved; i++)
+        {
+            const Task* task = &tasks[i];
+            atomic_fetch_add(&run->timesRemoved[(long long) task->id * run->numTasks + task->seq], 1);
+            if (task->seq <= lastSeq[task->id])
+            {
+                atomic_fetch_add(&run->outOfOrder, 1);
+            }
+            lastSeq[task->id] = task->seq;
+        }
+    }
+
+    free(lastSeq);
+    free(tasks);
+    return NULL;
+}
+
+int parseList(const char* const list, const char* const name, int* values)
+{
+    int numValues = 0;
+    const char* start = list;
+    char* endPtr;
+
+    //READ EACH VALUE UP TO THE NEXT COMMA
+    while (true)
+    {
+        const long value = strtol(start, &endPtr, 10);
+        if (endPtr == start || (*endPtr != ',' && *endPtr != '\0') ||
+            value < 1 || value > MAX_LIST_VALUE)
+        {
+            fprintf(stderr, "ERROR: %s must be an integer between 1 and %d.\n",
+                    name, MAX_LIST_VALUE);
+            return -1;
+        }
+        if (numValues == MAX_LIST_SIZE)
+        {
+            fprintf(stderr, "ERROR: At most %d values of %s can be given.\n",
+                    MAX_LIST_SIZE, name);
+            return -1;
+        }
+
+        values[numValues++] = (int) value;
+        if (*endPtr == '\0')
+        {
+            break;
+        }
+        start = endPtr + 1;
+    }
+
+    return numValues;
+}
+
+void printUsage()
+{
+    fprintf(stderr, "Usage: ./bufferBench [options]\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -p [producers]   The number of producer threads, %d by default.\n", DEFAULT_THREADS);
+    fprintf(stderr, "  -c [consumers]   The number of consumer threads, %d by default.\n", DEFAULT_THREADS);
+    fprintf(stderr, "  -n [tasks]       The tasks each producer inserts, %d by default.\n", DEFAULT_TASKS);
+    fprintf(stderr, "  -s [capacities]  Comma separated buffer capacities, %s by default.\n", DEFAULT_CAPACITIES);
+    fprintf(stderr, "  -b [batches]     Comma separated batch sizes, %s by default.\n", DEFAULT_BATCHES);
+    fprintf(stderr, "  -o [order]       fifo (default) or edf queue order.\n");
+    fprintf(stderr, "  -P               Run the producers and consumers as processes over a\n");
+    fprintf(stderr, "                   buffer in shared memory.\n");
+}
@@ -0,0 +1,177 @@
+/**
+ * @headerfile bufferBench.h
+ * @brief A stress test and microbenchmark of the Buffer on its own.
+ *
+ * A number of producer threads insert tasks into one Buffer while a number of
+ * consumer threads remove them, using the same locking and conditions as the
+ * scheduler. Every task carries the ID of the producer that made it and its
+ * place in that producer's sequence, so once a run has finished it is checked
+ * that every task was removed exactly once, and that each consumer removed the
+ * tasks of each producer in the order they were made.
+ *  A run is made for every combination of the given capacities and batch
+ * sizes. With a batch size of 1 every insertion and removal takes the lock on
+ * its own, larger batches insert or remove up to that many tasks each time the
+ * lock is held, as the scheduler's task thread does. The time per task and the
+ * tasks per second of each run are printed in a table.
+ *  The producers and consumers can also be run as processes, with the buffer
+ * and everything they share placed in shared memory, to compare the cost of
+ * handing tasks between processes with handing them between threads.
+ *  Build with 'make bench', or 'make bench TSAN=1' to run it under
+ * ThreadSanitizer. 'make bench PACKED=1' builds it with the fields of the
+ * Buffer packed together rather than kept on separate cache lines, see
+ * buffer.h, to compare the two layouts. The program exits with a failure if
+ * any check fails.
+ *
+ * @author Lachlan Mackenzie
+ * @date 18/10/26
+ */
+#ifndef BUFFER_BENCH_H
+#define BUFFER_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "buffer.h"
+#include "sharedMem.h"
+#include "task.h"
+#include "timeUtils.h"
+#include "parseUtils.h"
+
+//CONSTANTS
+/**
+ * The default number of producer and of consumer threads.
+ */
+#define DEFAULT_THREADS 2
+
+/**
+ * The default number of tasks each producer inserts in a run.
+ */
+#define DEFAULT_TASKS 200000
+
+/**
+ * The capacities run by default.
+ */
+#define DEFAULT_CAPACITIES "1,2,10,64,1024"
+
+/**
+ * The batch sizes run by default.
+ */
+#define DEFAULT_BATCHES "1,8"
+
+/**
+ * The largest number of producer or consumer threads.
+ */
+#define MAX_THREADS 256
+
+/**
+ * The largest number of capacities or batch sizes that can be given.
+ */
+#define MAX_LIST_SIZE 16
+
+/**
+ * The largest capacity and the largest batch size.
+ */
+#define MAX_LIST_VALUE 1000000
+
+//STRUCTS
+/**
+ * @brief Everything the threads of one run share.
+ *
+ * @field buffer The Buffer under test.
+ * @field numProducers The number of producer threads.
+ * @field numConsumers The number of consumer threads.
+ * @field numTasks The number of tasks each producer inserts.
+ * @field batch The most tasks inserted or removed each time the lock is held.
+ * @field producersLeft The number of producers still inserting, the last one
+ * to finish closes the buffer. Only accessed while holding the buffer's lock.
+ * @field timesRemoved How many times each task has been removed, indexed by
+ * producer * numTasks + sequence number.
+ * @field outOfOrder How many times a consumer removed a task of a producer
+ * before one that was made earlier.
+ * @field multiProcess True if the producers and consumers are processes, in
+ * which case the run, buffer and counts are all in shared memory.
+ */
+typedef struct
+{
+    Buffer* buffer;
+    int numProducers;
+    int numConsumers;
+    int numTasks;
+    int batch;
+    int producersLeft;
+    atomic_uchar* timesRemoved;
+    atomic_int outOfOrder;
+    bool multiProcess;
+} BenchRun;
+
+/**
+ * @brief This BenchArgs struct is used to pass a thread its ID and the run it
+ * belongs to.
+ *
+ * @field run The run the thread is part of.
+ * @field threadID The ID of the producer or consumer, starting from 0.
+ */
+typedef struct
+{
+    BenchRun* run;
+    int threadID;
+} BenchArgs;
+
+//FUNCTION PROTOTYPES
+/**
+ * @brief Runs the producers and consumers over one buffer and checks the result.
+ *
+ * @param run The run to perform, with every field but the counters set.
+ * @param elapsedNs Where to store how long the producers and consumers took.
+ * @return The number of checks that failed, 0 if the run was correct.
+ */
+int runBench(BenchRun* run, long long* elapsedNs);
+
+/**
+ * @brief Inserts this producer's tasks into the buffer, numbered in order.
+ *
+ * The task ID is the producer's ID and the task's sequence number is its place
+ * among that producer's tasks. Waits on @c emptyCond while the buffer is full.
+ * The last producer to finish closes the buffer.
+ *
+ * @param args A BenchArgs for the producer.
+ * @return NULL.
+ */
+void* producer(void* args);
+
+/**
+ * @brief Removes tasks from the buffer until it is drained.
+ *
+ * Each removed task is counted, and checked to come after the last task this
+ * consumer removed from the same producer.
+ *
+ * @param args A BenchArgs for the consumer.
+ * @return NULL.
+ */
+void* consumer(void* args);
+
+/**
+ * @brief Parses a comma separated list of positive integers, e.g. "1,8".
+ *
+ * Prints an error to stderr if a value is not an integer between 1 and
+ * MAX_LIST_VALUE, or there are more than MAX_LIST_SIZE values.
+ *
+ * @param list The list of values.
+ * @param name What the values are, used in the error.
+ * @param values The array to store the values in, of length MAX_LIST_SIZE.
+ * @return The number of values in the list, or -1 on an error.
+ */
+int parseList(const char* const list, const char* const name, int* values);
+
+/**
+ * @brief Prints how to use the program to stderr.
+ */
+void printUsage();
+
+#endif
@@ -0,0 +1,216 @@
+/**
+ * See documentation in the header file.
+ */
+#include "coroutine.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "timeUtils.h"
+
+/**
+ * The coroutine currently running on this OS thread, NULL if there is none.
+ */
+static _Thread_local Coroutine* current_coroutine = NULL;
+
+/**
+ * The run loop of this OS thread, NULL if it is not part of a pool.
+ */
+static _Thread_local RunLoop* current_loop = NULL;
+
+/**
+ * The arguments each OS thread of the pool is started with.
+ */
+typedef struct
+{
+    CoroutinePool* pool;
+    int threadNum;
+} LoopArgs;
+
+/**
+ * Adds a coroutine to the heap of sleeping coroutines, sifting it up into place.
+ */
+static void heapPush(RunLoop* loop, Coroutine* coroutine)
+{
+    int i = loop->numSleeping++;
+    while (i > 0 && loop->sleeping[(i - 1) / 2]->wakeNs > coroutine->wakeNs)
+    {
+        loop->sleeping[i] = loop->sleeping[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    loop->sleeping[i] = coroutine;
+}
+
+/**
+ * Removes the coroutine due to wake first from the heap, sifting the last one
+ * down into its place.
+ */
+static Coroutine* heapPop(RunLoop* loop)
+{
+    Coroutine* top = loop->sleeping[0];
+    Coroutine* last = loop->sleeping[--loop->numSleeping];
+    int i = 0;
+    while (2 * i + 1 < loop->numSleeping)
+    {
+        int child = 2 * i + 1;
+        if (child + 1 < loop->numSleeping &&
+            loop->sleeping[child + 1]->wakeNs < loop->sleeping[child]->wakeNs)
+        {
+            child++;
+        }
+        if (loop->sleeping[child]->wakeNs >= last->wakeNs)
+        {
+            break;
+        }
+        loop->sleeping[i] = loop->sleeping[child];
+        i = child;
+    }
+    loop->sleeping[i] = last;
+
+    return top;
+}
+
+/**
+ * The first function run on every coroutine's stack. When it returns the
+ * coroutine's uc_link switches back to its run loop.
+ */
+static void coroutineEntry()
+{
+    Coroutine* coroutine = current_coroutine;
+    coroutine->function(coroutine->arg);
+    coroutine->finished = true;
+}
+
+/**
+ * The function each OS thread of the pool runs, resuming its coroutines in the
+ * order they are due to wake until they have all finished.
+ */
+static void* runLoop(void* loopArgs)
+{
+    CoroutinePool* pool = ((LoopArgs*) loopArgs)->pool;
+    const int threadNum = ((LoopArgs*) loopArgs)->threadNum;
+    RunLoop* loop = &pool->loops[threadNum - 1];
+    current_loop = loop;
+
+    if (pool->onThreadStart != NULL)
+    {
+        pool->onThreadStart(threadNum, pool->onThreadStartArg);
+    }
+
+    while (loop->numSleeping > 0)
+    {
+        //SLEEP THE OS THREAD UNTIL THE NEXT COROUTINE IS DUE TO WAKE
+        long long wakeNs = loop->sleeping[0]->wakeNs;
+        if (wakeNs > getTimeNanos())
+        {
+            struct timespec wakeTime;
+            wakeTime.tv_sec = wakeNs / 1000000000LL;
+            wakeTime.tv_nsec = wakeNs % 1000000000LL;
+            //ONLY A SIGNAL CUTS THE SLEEP SHORT, ANY OTHER ERROR WOULD RECUR
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeTime, NULL) == EINTR);
+        }
+
+        //RESUME IT, IT PUTS ITSELF BACK IN THE HEAP IF IT SLEEPS AGAIN
+        Coroutine* coroutine = heapPop(loop);
+        current_coroutine = coroutine;
+        swapcontext(&loop->context, &coroutine->context);
+        current_coroutine = NULL;
+    }
+
+    return NULL;
+}
+
+CoroutinePool* coroutinePool_create(int numThreads,
+                                    void (*onThreadStart)(int threadNum, void* arg),
+                                    void* onThreadStartArg)
+{
+    CoroutinePool* pool = malloc(sizeof(CoroutinePool));
+    pool->loops = calloc(numThreads, sizeof(RunLoop));
+    pool->numThreads = numThreads;
+    pool->coroutines = NULL;
+    pool->numCoroutines = 0;
+    pool->onThreadStart = onThreadStart;
+    pool->onThreadStartArg = onThreadStartArg;
+
+    return pool;
+}
+
+void coroutinePool_free(CoroutinePool* pool)
+{
+    for (int i = 0; i < pool->numCoroutines; i++)
+    {
+        munmap(pool->coroutines[i]->stack, COROUTINE_STACK_SIZE);
+        free(pool->coroutines[i]);
+    }
+    for (int i = 0; i < pool->numThreads; i++)
+    {
+        free(pool->loops[i].sleeping);
+    }
+    free(pool->coroutines);
+    free(pool->loops);
+    free(pool);
+}
+
+bool coroutinePool_spawn(CoroutinePool* pool, void (*function)(void*), void* arg)
+{
+    Coroutine* coroutine = malloc(sizeof(Coroutine));
+    coroutine->stack = mmap(NULL, COROUTINE_STACK_SIZE, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (coroutine->stack == MAP_FAILED)
+    {
+        perror("ERROR: A coroutine stack could not be mapped ");
+        free(coroutine);
+        return false;
+    }
+    coroutine->function = function;
+    coroutine->arg = arg;
+    coroutine->wakeNs = 0;
+    coroutine->finished = false;
+
+    //GIVE THE COROUTINES TO EACH OS THREAD IN TURN
+    RunLoop* loop = &pool->loops[pool->numCoroutines % pool->numThreads];
+    getcontext(&coroutine->context);
+    coroutine->context.uc_stack.ss_sp = coroutine->stack;
+    coroutine->context.uc_stack.ss_size = COROUTINE_STACK_SIZE;
+    coroutine->context.uc_link = &loop->context;
+    makecontext(&coroutine->context, coroutineEntry, 0);
+
+    loop->numCoroutines++;
+    loop->sleeping = realloc(loop->sleeping, sizeof(Coroutine*) * loop->numCoroutines);
+    heapPush(loop, coroutine);
+
+    pool->coroutines = realloc(pool->coroutines, sizeof(Coroutine*) * (pool->numCoroutines + 1));
+    pool->coroutines[pool->numCoroutines++] = coroutine;
+
+    return true;
+}
+
+void coroutinePool_run(CoroutinePool* pool)
+{
+    LoopArgs* loopArgs = malloc(sizeof(LoopArgs) * pool->numThreads);
+    for (int i = 0; i < pool->numThreads; i++)
+    {
+        loopArgs[i].pool = pool;
+        loopArgs[i].threadNum = i + 1;
+        pthread_create(&pool->loops[i].thread, NULL, runLoop, &loopArgs[i]);
+    }
+    for (int i = 0; i < pool->numThreads; i++)
+    {
+        pthread_join(pool->loops[i].thread, NULL);
+    }
+    free(loopArgs);
+}
+
+bool coroutine_isRunning()
+{
+    return current_coroutine != NULL;
+}
+
+void coroutine_sleep(long long ns)
+{
+    Coroutine* coroutine = current_coroutine;
+    coroutine->wakeNs = getTimeNanos() + ns;
+    heapPush(current_loop, coroutine);
+    swapcontext(&coroutine->context, &current_loop->context);
+}
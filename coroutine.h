@@ -0,0 +1,161 @@
+/**
+ * @headerfile coroutine.h
+ * @brief Defines a pool of user-space coroutines multiplexed over a small number
+ * of OS threads, used to simulate far more CPUs than it would be sensible to
+ * create threads for.
+ *
+ * Each coroutine runs a function on its own small stack and gives up its OS
+ * thread whenever it sleeps. Every OS thread in the pool runs a timer driven
+ * loop over the coroutines it owns: it resumes whichever coroutine is due to
+ * wake first, sleeping the OS thread until then if none are due yet. A
+ * coroutine always stays on the OS thread it was given, so the loops share
+ * nothing and need no locking.
+ *  A coroutine must never block its OS thread for long, as that stalls every
+ * other coroutine on the same thread. It should call coroutine_sleep() instead.
+ *
+ * @author Lachlan Mackenzie
+ * @date 18/10/26
+ */
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <ucontext.h>
+#include <pthread.h>
+
+//CONSTANTS
+/**
+ * The size of each coroutine's stack in bytes. The memory is reserved up front
+ * but only the pages a coroutine actually touches are ever allocated.
+ */
+#define COROUTINE_STACK_SIZE (64 * 1024)
+
+//STRUCTS
+/**
+ * @brief This Coroutine struct is used to store the state of one coroutine.
+ *
+ * @field context The saved registers and stack of the coroutine while it is not
+ * running.
+ * @field stack The memory used as the coroutine's stack.
+ * @field function The function the coroutine runs.
+ * @field arg The argument passed to @c function.
+ * @field wakeNs The time, from getTimeNanos(), the coroutine is due to resume.
+ * @field finished True once @c function has returned.
+ */
+typedef struct
+{
+    ucontext_t context;
+    void* stack;
+    void (*function)(void*);
+    void* arg;
+    long long wakeNs;
+    bool finished;
+} Coroutine;
+
+/**
+ * @brief This RunLoop struct is used to store the coroutines owned by one OS
+ * thread of the pool.
+ *
+ * @field context The saved state of the loop while a coroutine is running.
+ * @field sleeping A binary min-heap of the coroutines that have not finished,
+ * ordered by the time they are due to wake.
+ * @field numSleeping The number of coroutines in @c sleeping.
+ * @field numCoroutines The number of coroutines given to this loop.
+ * @field thread The OS thread running the loop.
+ */
+typedef struct
+{
+    ucontext_t context;
+    Coroutine** sleeping;
+    int numSleeping;
+    int numCoroutines;
+    pthread_t thread;
+} RunLoop;
+
+/**
+ * @brief This CoroutinePool struct is used to store the OS threads of the pool
+ * and the coroutines spawned onto them.
+ *
+ * @field loops The run loop of each OS thread.
+ * @field numThreads The number of OS threads.
+ * @field coroutines Every coroutine spawned onto the pool.
+ * @field numCoroutines The number of coroutines spawned.
+ * @field onThreadStart Called by each OS thread before it runs any coroutines,
+ * may be NULL.
+ * @field onThreadStartArg The argument passed to @c onThreadStart.
+ */
+typedef struct
+{
+    RunLoop* loops;
+    int numThreads;
+    Coroutine** coroutines;
+    int numCoroutines;
+    void (*onThreadStart)(int threadNum, void* arg);
+    void* onThreadStartArg;
+} CoroutinePool;
+
+//FUNCTION PROTOTYPES
+/**
+ * @brief Creates a CoroutinePool and allocates memory to it on the heap.
+ *
+ * No OS threads are started until coroutinePool_run() is called.
+ *
+ * @param numThreads The number of OS threads to multiplex the coroutines over.
+ * @param onThreadStart Called with the thread's number, from 1, and
+ * @p onThreadStartArg by each OS thread as it starts, or NULL.
+ * @param onThreadStartArg The argument passed to @p onThreadStart.
+ * @return A pointer to the CoroutinePool struct on the heap.
+ */
+CoroutinePool* coroutinePool_create(int numThreads,
+                                    void (*onThreadStart)(int threadNum, void* arg),
+                                    void* onThreadStartArg);
+
+/**
+ * @brief Deallocates all memory associated with the specified CoroutinePool,
+ * including the stacks of its coroutines.
+ *
+ * @param pool The CoroutinePool to deallocate from memory.
+ */
+void coroutinePool_free(CoroutinePool* pool);
+
+/**
+ * @brief Adds a coroutine that will run @p function with @p arg to the pool.
+ *
+ * Coroutines are shared between the OS threads in turn. Must be called before
+ * coroutinePool_run(). An error is printed to stderr if the coroutine's stack
+ * can not be mapped, and the coroutine is not added.
+ *
+ * @param pool The pool to add the coroutine to.
+ * @param function The function for the coroutine to run.
+ * @param arg The argument passed to @p function.
+ * @return True if the coroutine was added.
+ */
+bool coroutinePool_spawn(CoroutinePool* pool, void (*function)(void*), void* arg);
+
+/**
+ * @brief Starts the pool's OS threads and waits until every coroutine has
+ * finished.
+ *
+ * @param pool The pool to run.
+ */
+void coroutinePool_run(CoroutinePool* pool);
+
+/**
+ * @brief Returns true if the caller is running inside a coroutine.
+ *
+ * @return True if the caller is a coroutine, false if it is a plain thread.
+ */
+bool coroutine_isRunning();
+
+/**
+ * @brief Suspends the calling coroutine for at least the given time, letting
+ * the other coroutines on its OS thread run in the meantime.
+ *
+ * Must only be called from inside a coroutine.
+ *
+ * @param ns How long to sleep for in nanoseconds, 0 to just let others run.
+ */
+void coroutine_sleep(long long ns);
+
+#endif
@@ -0,0 +1,233 @@
+/**
+ * See documentation in the header file.
+ */
+#include "lockStats.h"
+
+#ifdef LOCK_STATS
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timeUtils.h"
+
+/**
+ * The longest thread name that is kept, including the null terminator.
+ */
+#define MAX_THREAD_NAME 32
+
+/**
+ * The names each lock and condition are logged under, in LockStatID order.
+ */
+static const char* const LOCK_NAMES[NUM_LOCK_STATS] =
+{
+    "buffer mutex", "log mutex", "info mutex", "fullCond", "emptyCond"
+};
+
+/**
+ * @brief The counters of one thread for one lock or condition.
+ *
+ * @field acquisitions How many times the lock was taken or the condition waited on.
+ * @field contended How many of those times the lock was already held.
+ * @field waitNs The total time spent blocked acquiring or waiting.
+ * @field maxWaitNs The longest single block.
+ * @field holdNs The total time the lock was held.
+ * @field maxHoldNs The longest single hold.
+ * @field heldSince When the current hold started.
+ */
+typedef struct
+{
+    long acquisitions;
+    long contended;
+    long long waitNs;
+    long long maxWaitNs;
+    long long holdNs;
+    long long maxHoldNs;
+    long long heldSince;
+} LockCounters;
+
+/**
+ * @brief The counters of one registered thread.
+ */
+typedef struct
+{
+    char name[MAX_THREAD_NAME];
+    LockCounters counters[NUM_LOCK_STATS];
+} ThreadLockStats;
+
+struct LockStats
+{
+    ThreadLockStats** threads;
+    int numThreads;
+    pthread_mutex_t mutex;
+};
+
+/**
+ * The counters of the calling thread, NULL if it has not registered. Only the
+ * owning thread writes to them, so recording needs no locking.
+ */
+static _Thread_local ThreadLockStats* thread_stats = NULL;
+
+static void addWait(LockCounters* counters, long long waitNs)
+{
+    counters->waitNs += waitNs;
+    if (waitNs > counters->maxWaitNs)
+    {
+        counters->maxWaitNs = waitNs;
+    }
+}
+
+static void endHold(LockCounters* counters, long long now)
+{
+    long long holdNs = now - counters->heldSince;
+    counters->holdNs += holdNs;
+    if (holdNs > counters->maxHoldNs)
+    {
+        counters->maxHoldNs = holdNs;
+    }
+}
+
+static void logCounters(FILE* outFile, const char* name, const LockCounters* const counters)
+{
+    fprintf(outFile, "  %-12s acquisitions: %ld, contended: %ld, "
+            "wait: %.3f ms (max %.3f ms), hold: %.3f ms (max %.3f ms)\n",
+            name, counters->acquisitions, counters->contended,
+            counters->waitNs / 1e6, counters->maxWaitNs / 1e6,
+            counters->holdNs / 1e6, counters->maxHoldNs / 1e6);
+}
+
+LockStats* lockStats_create()
+{
+    LockStats* stats = malloc(sizeof(LockStats));
+    stats->threads = NULL;
+    stats->numThreads = 0;
+    pthread_mutex_init(&stats->mutex, NULL);
+
+    return stats;
+}
+
+void lockStats_free(LockStats* stats)
+{
+    for (int i = 0; i < stats->numThreads; i++)
+    {
+        free(stats->threads[i]);
+    }
+    free(stats->threads);
+    pthread_mutex_destroy(&stats->mutex);
+    free(stats);
+}
+
+void lockStats_registerThread(LockStats* stats, const char* name)
+{
+    ThreadLockStats* threadStats = calloc(1, sizeof(ThreadLockStats));
+    strncpy(threadStats->name, name, MAX_THREAD_NAME - 1);
+
+    pthread_mutex_lock(&stats->mutex);
+    stats->threads = realloc(stats->threads, sizeof(ThreadLockStats*) * (stats->numThreads + 1));
+    stats->threads[stats->numThreads++] = threadStats;
+    pthread_mutex_unlock(&stats->mutex);
+
+    thread_stats = threadStats;
+}
+
+void lockStats_lock(pthread_mutex_t* mutex, LockStatID id)
+{
+    if (thread_stats == NULL)
+    {
+        sharedMem_lock(mutex);
+        return;
+    }
+
+    LockCounters* counters = &thread_stats->counters[id];
+    counters->acquisitions++;
+    //ONLY TIME THE ACQUISITION WHEN THE LOCK IS ALREADY HELD BY ANOTHER THREAD
+    const int result = pthread_mutex_trylock(mutex);
+    if (result == EOWNERDEAD)
+    {
+        pthread_mutex_consistent(mutex);
+    }
+    if (result == EBUSY)
+    {
+        counters->contended++;
+        long long start = getTimeNanos();
+        sharedMem_lock(mutex);
+        counters->heldSince = getTimeNanos();
+        addWait(counters, counters->heldSince - start);
+    }
+    else
+    {
+        counters->heldSince = getTimeNanos();
+    }
+}
+
+void lockStats_unlock(pthread_mutex_t* mutex, LockStatID id)
+{
+    if (thread_stats != NULL)
+    {
+        endHold(&thread_stats->counters[id], getTimeNanos());
+    }
+    pthread_mutex_unlock(mutex);
+}
+
+void lockStats_wait(pthread_cond_t* cond, pthread_mutex_t* mutex,
+                    LockStatID condID, LockStatID mutexID)
+{
+    if (thread_stats == NULL)
+    {
+        sharedMem_wait(cond, mutex);
+        return;
+    }
+
+    LockCounters* condCounters = &thread_stats->counters[condID];
+    LockCounters* mutexCounters = &thread_stats->counters[mutexID];
+    long long start = getTimeNanos();
+    endHold(mutexCounters, start);
+
+    sharedMem_wait(cond, mutex);
+
+    long long end = getTimeNanos();
+    condCounters->acquisitions++;
+    addWait(condCounters, end - start);
+    mutexCounters->heldSince = end;
+}
+
+void lockStats_log(const LockStats* const stats, FILE* outFile)
+{
+    LockCounters totals[NUM_LOCK_STATS];
+    memset(totals, 0, sizeof(totals));
+
+    fprintf(outFile, "\nLock statistics\n");
+    for (int i = 0; i < stats->numThreads; i++)
+    {
+        const ThreadLockStats* threadStats = stats->threads[i];
+        fprintf(outFile, "Thread %s\n", threadStats->name);
+        for (int id = 0; id < NUM_LOCK_STATS; id++)
+        {
+            const LockCounters* counters = &threadStats->counters[id];
+            if (counters->acquisitions > 0)
+            {
+                logCounters(outFile, LOCK_NAMES[id], counters);
+            }
+
+            totals[id].acquisitions += counters->acquisitions;
+            totals[id].contended += counters->contended;
+            totals[id].waitNs += counters->waitNs;
+            totals[id].holdNs += counters->holdNs;
+            if (counters->maxWaitNs > totals[id].maxWaitNs)
+            {
+                totals[id].maxWaitNs = counters->maxWaitNs;
+            }
+            if (counters->maxHoldNs > totals[id].maxHoldNs)
+            {
+                totals[id].maxHoldNs = counters->maxHoldNs;
+            }
+        }
+    }
+
+    fprintf(outFile, "All threads\n");
+    for (int id = 0; id < NUM_LOCK_STATS; id++)
+    {
+        logCounters(outFile, LOCK_NAMES[id], &totals[id]);
+    }
+}
+
+#endif
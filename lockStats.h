@@ -0,0 +1,129 @@
+/**
+ * @headerfile lockStats.h
+ * @brief Optional instrumentation of the locks and condition waits used by the
+ * scheduler's threads.
+ *
+ * When compiled with LOCK_STATS defined (make LOCK_STATS=1), every lock, unlock
+ * and condition wait made through these functions records how often the lock
+ * was taken, how often it was already held, how long the caller waited and how
+ * long it held the lock. The counters are kept per thread and per lock, and are
+ * written to the end of the log once the threads have finished.
+ *  When LOCK_STATS is not defined each function is replaced by the plain pthread
+ * call, or by nothing at all, so the instrumentation costs nothing.
+ *
+ * @author Lachlan Mackenzie
+ * @date 18/10/26
+ */
+#ifndef LOCKSTATS_H
+#define LOCKSTATS_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include "sharedMem.h"
+
+//CONSTANTS
+/**
+ * @brief Identifies each of the locks and conditions that are instrumented.
+ *
+ * @c NUM_LOCK_STATS is not a lock, it is the number of entries before it.
+ */
+typedef enum
+{
+    LOCK_BUFFER,
+    LOCK_LOG,
+    LOCK_INFO,
+    COND_FULL,
+    COND_EMPTY,
+    NUM_LOCK_STATS
+} LockStatID;
+
+//STRUCTS
+/**
+ * @brief The collection of every registered thread's lock counters. Its
+ * definition is private to lockStats.c.
+ */
+typedef struct LockStats LockStats;
+
+#ifdef LOCK_STATS
+
+//FUNCTION PROTOTYPES
+/**
+ * @brief Creates an empty LockStats struct and allocates memory to it on the heap.
+ *
+ * @return A pointer to the LockStats struct on the heap.
+ */
+LockStats* lockStats_create();
+
+/**
+ * @brief Deallocates the LockStats struct and the counters of every thread
+ * registered with it.
+ *
+ * @param stats The LockStats to deallocate from memory.
+ */
+void lockStats_free(LockStats* stats);
+
+/**
+ * @brief Gives the calling thread its own set of counters in @p stats.
+ *
+ * Every instrumented call the thread makes afterwards is recorded against these
+ * counters. Calls made by threads that never registered are not recorded.
+ *
+ * @param stats The LockStats the thread's counters belong to.
+ * @param name The name the thread's counters are logged under.
+ */
+void lockStats_registerThread(LockStats* stats, const char* name);
+
+/**
+ * @brief Locks @p mutex, recording whether it was contended and how long it
+ * took to acquire.
+ *
+ * @param mutex The mutex to lock.
+ * @param id Which lock @p mutex is.
+ */
+void lockStats_lock(pthread_mutex_t* mutex, LockStatID id);
+
+/**
+ * @brief Unlocks @p mutex, recording how long it was held.
+ *
+ * @param mutex The mutex to unlock.
+ * @param id Which lock @p mutex is.
+ */
+void lockStats_unlock(pthread_mutex_t* mutex, LockStatID id);
+
+/**
+ * @brief Waits on @p cond, recording how long the thread waited.
+ *
+ * The time spent waiting is not counted as time holding @p mutex.
+ *
+ * @param cond The condition to wait on.
+ * @param mutex The mutex held by the caller, released while waiting.
+ * @param condID Which condition @p cond is.
+ * @param mutexID Which lock @p mutex is.
+ */
+void lockStats_wait(pthread_cond_t* cond, pthread_mutex_t* mutex,
+                    LockStatID condID, LockStatID mutexID);
+
+/**
+ * @brief Logs the counters of every registered thread, followed by the totals
+ * for each lock, to the given file.
+ *
+ * Must only be called once the registered threads have finished.
+ *
+ * @param stats The LockStats to log.
+ * @param outFile The file to write the statistics to.
+ */
+void lockStats_log(const LockStats* const stats, FILE* outFile);
+
+#else
+
+#define lockStats_create() NULL
+#define lockStats_free(stats) ((void) 0)
+#define lockStats_registerThread(stats, name) ((void) 0)
+#define lockStats_lock(mutex, id) sharedMem_lock(mutex)
+#define lockStats_unlock(mutex, id) pthread_mutex_unlock(mutex)
+#define lockStats_wait(cond, mutex, condID, mutexID) sharedMem_wait(cond, mutex)
+#define lockStats_log(stats, outFile) ((void) 0)
+
+#endif
+
+#endif
@@ -3,18 +3,62 @@
  */
 #include "logFile.h"
 
-Log* log_create(const char* filename)
+Log* log_create(const char* filename, LogLevel level, int sampleEvery)
 {
     Log* logfile = malloc(sizeof(Log));
     logfile->file = fopen(filename, "w");
+    logfile->shared = false;
+    logfile->level = level;
+    logfile->sampleEvery = sampleEvery;
     pthread_mutex_init(&logfile->mutex, NULL);
 
     return logfile;
 }
 
+Log* log_createShared(const char* filename, LogLevel level, int sampleEvery)
+{
+    Log* logfile = sharedMem_alloc(sizeof(Log));
+    if (logfile == NULL)
+    {
+        return NULL;
+    }
+    logfile->file = fopen(filename, "w");
+    if (logfile->file != NULL)
+    {
+        setvbuf(logfile->file, NULL, _IONBF, 0);
+    }
+    logfile->shared = true;
+    logfile->level = level;
+    logfile->sampleEvery = sampleEvery;
+
+    sharedMem_initMutex(&logfile->mutex, true);
+
+    return logfile;
+}
+
+bool log_wants(const Log* const logfile, LogLevel level)
+{
+    return level <= logfile->level;
+}
+
+bool log_wantsTask(const Log* const logfile, int seq)
+{
+    return logfile->level == LOG_EVENT && seq % logfile->sampleEvery == 0;
+}
+
 void log_free(Log* logfile)
 {
-    fclose(logfile->file);
+    if (logfile->file != NULL)
+    {
+        fclose(logfile->file);
+    }
     pthread_mutex_destroy(&logfile->mutex);
-    free(logfile);
+    if (logfile->shared)
+    {
+        sharedMem_free(logfile);
+    }
+    else
+    {
+        free(logfile);
+    }
 }
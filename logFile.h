@@ -12,7 +12,27 @@
 #include <stdio.h>
 #include <pthread.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include "sharedMem.h"
 
+//CONSTANTS
+/**
+ * @brief How much is written to a Log, each level including everything in the
+ * levels before it.
+ *
+ * @c LOG_SUMMARY only writes the statistics of the whole run. @c LOG_CPU also
+ * writes what each thread, or process, did once it finishes, and each change
+ * made while tuning the Ready Queue. @c LOG_EVENT also writes the arrival,
+ * service and completion of each task, or of a sample of them.
+ */
+typedef enum
+{
+    LOG_SUMMARY,
+    LOG_CPU,
+    LOG_EVENT
+} LogLevel;
+
+//STRUCTS
 /**
  * @brief This Log struct is used to store the file pointer and the mutex lock
  * used to access it safely between threads.
@@ -20,22 +40,74 @@
  * @field file The output file that is shared between the task and cpu threads.
  * @field mutex The lock that ensures mutual exclusion on threads accessing the
  * file.
+ * @field shared True if the Log is in shared memory, to be written to by several
+ * processes.
+ * @field level How much is written to the file.
+ * @field sampleEvery Only the events of one in this many tasks are written, so
+ * 1 writes them all.
  */
 typedef struct
 {
     FILE* file;
     pthread_mutex_t mutex;
+    bool shared;
+    LogLevel level;
+    int sampleEvery;
 } Log;
 
+//FUNCTION PROTOTYPES
+
 /**
  * @brief Creates a Log struct and allocates memory to it on the heap.
  *
  * The file with the given filename is opened and the mutex is initialised.
  *
  * @param filename The name of the file to share between threads.
+ * @param level How much to write to the file.
+ * @param sampleEvery Write the events of one in this many tasks.
  * @return A pointer to the SchedulerInfo struct on the heap.
  */
-Log* log_create(const char* filename);
+Log* log_create(const char* filename, LogLevel level, int sampleEvery);
+
+/**
+ * @brief Creates a Log struct in shared memory, for processes forked afterwards
+ * to write to.
+ *
+ * The mutex is process-shared. The file is not buffered, so everything written
+ * while holding the mutex reaches the file before another process can take it.
+ *
+ * @param filename The name of the file to share between processes.
+ * @param level How much to write to the file.
+ * @param sampleEvery Write the events of one in this many tasks.
+ * @return A pointer to the Log struct in shared memory, or NULL if the shared
+ * memory could not be created.
+ */
+Log* log_createShared(const char* filename, LogLevel level, int sampleEvery);
+
+/**
+ * @brief Returns true if the Log writes what is logged at the given level.
+ *
+ * Checked before taking the mutex, so nothing is locked or formatted for what
+ * would not be written.
+ *
+ * @param logfile The Log to check.
+ * @param level The level of what would be logged.
+ * @return True if it should be logged.
+ */
+bool log_wants(const Log* const logfile, LogLevel level);
+
+/**
+ * @brief Returns true if the Log writes the events of the given task.
+ *
+ * The sample is chosen by the task's position alone, so the same tasks are
+ * sampled on every run, and a task's arrival, service and completion are
+ * always written or skipped together.
+ *
+ * @param logfile The Log to check.
+ * @param seq The position of the task, see Task.
+ * @return True if the task's events should be logged.
+ */
+bool log_wantsTask(const Log* const logfile, int seq);
 
 /**
  * @brief Deallocates all memory associated with the specified Log struct.
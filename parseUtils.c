@@ -0,0 +1,17 @@
+/**
+ * See documentation in the header file.
+ */
+#include "parseUtils.h"
+
+int parseCount(const char* const value, const char* const name, int max)
+{
+    char* endPtr;
+    const long count = strtol(value, &endPtr, 10);
+    if (endPtr == value || *endPtr != '\0' || count < 1 || count > max)
+    {
+        fprintf(stderr, "ERROR: %s must be an integer between 1 and %d.\n", name, max);
+        return -1;
+    }
+
+    return (int) count;
+}
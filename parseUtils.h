@@ -0,0 +1,26 @@
+/**
+ * @headerfile parseUtils.h
+ * @brief File containing functions for parsing the command line options shared
+ * by the scheduler and the buffer benchmark.
+ *
+ * @author Lachlan Mackenzie
+ * @date 18/10/26
+ */
+#ifndef PARSEUTILS_H
+#define PARSEUTILS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief Parses a positive integer option, printing an error to stderr if it
+ * is not an integer between 1 and @p max.
+ *
+ * @param value The text of the option.
+ * @param name The name of the option to use in the error.
+ * @param max The largest allowed value.
+ * @return The integer, or -1 on an error.
+ */
+int parseCount(const char* const value, const char* const name, int max);
+
+#endif
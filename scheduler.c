@@ -3,272 +3,1357 @@
  */
 #include "scheduler.h"
 
+/**
+ * The names of each dispatch mode on the command line and in the output, in
+ * DispatchMode order.
+ */
+static const char* const DISPATCH_NAMES[] = {"fcfs", "eft"};
+
+/**
+ * The names of each order of the Ready Queue on the command line and in the
+ * output, in BufferOrder order.
+ */
+static const char* const ORDER_NAMES[] = {"fifo", "edf"};
+
+/**
+ * The names of each verbosity of the log on the command line and in the
+ * output, in LogLevel order.
+ */
+static const char* const VERBOSITY_NAMES[] = {"summary", "cpu", "event"};
+
 int main(int argc, char* argv[])
 {
+    //PARSE THE OPTIONS THAT COME BEFORE THE TASK FILE AND QUEUE SIZE
+    const char* traceFile = NULL;
+    const char* speedList = NULL;
+    const char* speedFile = NULL;
+    const char* dispatchList = "fcfs";
+    const char* orderList = "fifo";
+    const char* capacityBounds = NULL;
+    const char* batchBounds = NULL;
+    const char* verbosity = "event";
+    int sampleEvery = 1;
+    bool admissionControl = false, multiProcess = false, online = false;
+    int numCpus = 0, numWorkerThreads = 0;
+    int option;
+    while ((option = getopt(argc, argv, "t:c:m:f:F:d:q:aPiA:B:v:s:")) != -1)
+    {
+        switch (option)
+        {
+            case 't':
+                traceFile = optarg;
+                break;
+            case 'c':
+                if ((numCpus = parseCount(optarg, "Number of CPUs", MAX_CPUS)) == -1)
+                {
+                    return -1;
+                }
+                break;
+            case 'm':
+                if ((numWorkerThreads = parseCount(optarg, "Number of OS threads", MAX_CPUS)) == -1)
+                {
+                    return -1;
+                }
+                break;
+            case 'f':
+                speedList = optarg;
+                break;
+            case 'F':
+                speedFile = optarg;
+                break;
+            case 'd':
+                dispatchList = optarg;
+                break;
+            case 'q':
+                orderList = optarg;
+                break;
+            case 'a':
+                admissionControl = true;
+                break;
+            case 'P':
+                multiProcess = true;
+                break;
+            case 'i':
+                online = true;
+                break;
+            case 'A':
+                capacityBounds = optarg;
+                break;
+            case 'B':
+                batchBounds = optarg;
+                break;
+            case 'v':
+                verbosity = optarg;
+                break;
+            case 's':
+                if ((sampleEvery = parseCount(optarg, "Sample rate", MAX_SAMPLE_EVERY)) == -1)
+                {
+                    return -1;
+                }
+                break;
+            default:
+                printUsage();
+                return -1;
+        }
+    }
+
     //ENSURE CORRECT AMOUNT OF COMMAND LINE ARGUMENTS ARE PRESENT
-    if (argc != NUM_ARGS + 1)
+    if (argc - optind != NUM_ARGS)
     {
         fprintf(stderr, "ERROR: Invalid number of command line arguments.\n");
-        fprintf(stderr, "Usage: ./scheduler [task file name] [queue size]\n");
+        printUsage();
         return -1;
     }
 
     //RENAME COMMAND LINE ARGUMENTS FOR READABILITY
-    const char* taskFile = argv[1];
-    char* endPtr;
-    const int bufferSize = (int) strtol(argv[2], &endPtr, 10);
+    const char* taskFile = argv[optind];
+    int bufferSizes[MAX_SWEEP_SIZE];
+    int dispatchModes[MAX_SWEEP_SIZE], orders[MAX_SWEEP_SIZE];
+    const int numSizes = parseQueueSizes(argv[optind + 1], bufferSizes);
+    const int numModes = parseModeList(dispatchList, DISPATCH_NAMES, DISPATCH_EFT + 1,
+                                       "Dispatch mode", dispatchModes);
+    const int numOrders = parseModeList(orderList, ORDER_NAMES, BUFFER_EDF + 1,
+                                        "Queue order", orders);
+    if (numSizes == -1 || numModes == -1 || numOrders == -1)
+    {
+        return -1;
+    }
 
-    //CHECK THAT bufferSize IS WITHIN A VALID RANGE
-    if (*endPtr != '\0' || bufferSize < MIN_BUFFER_CAP || bufferSize > MAX_BUFFER_CAP)
+    //EVERY SIMULATION IS LOGGED AT THE SAME VERBOSITY, AND ONLY EVENTS ARE SAMPLED
+    int level = LOG_SUMMARY;
+    while (level <= LOG_EVENT && strcmp(verbosity, VERBOSITY_NAMES[level]) != 0)
     {
-        fprintf(stderr, "ERROR: Buffer size must be an integer between 1 and 10.\n");
+        level++;
+    }
+    if (level > LOG_EVENT)
+    {
+        fprintf(stderr, "ERROR: Verbosity must be one of:");
+        for (int l = LOG_SUMMARY; l <= LOG_EVENT; l++)
+        {
+            fprintf(stderr, " %s", VERBOSITY_NAMES[l]);
+        }
+        fprintf(stderr, ".\n");
         return -1;
     }
+    if (sampleEvery > 1 && level != LOG_EVENT)
+    {
+        fprintf(stderr, "ERROR: -s can only be used with event verbosity.\n");
+        return -1;
+    }
+    const int numSims = numSizes * numModes * numOrders;
 
-    //INITIALISE GLOBAL VARIABLES FOR THREAD SHARING
-    total_num_tasks = getNumTasks(taskFile);
-    task_buffer = buffer_create(bufferSize);
-    sim_log = log_create("simulation_log");
-    if (sim_log->file == NULL)
+    //EACH PROCESS WOULD HAVE ITS OWN COPY OF THE TRACE AND COROUTINES, AND ONLY
+    // THE THREAD THAT FORKS IS COPIED INTO A CHILD, SO A SWEEP CAN NOT FORK
+    if (multiProcess && (traceFile != NULL || numWorkerThreads > 0 || numSims > 1))
     {
-        perror("ERROR: The log file could not be opened/created.\n");
-        buffer_free(task_buffer);
-        log_free(sim_log);
+        fprintf(stderr, "ERROR: -P can not be used with -t, -m or more than one simulation.\n");
         return -1;
     }
-    cpu_info = schedulerInfo_create();
 
-    //CREATE THREADS
-    pthread_t* taskThread = (pthread_t*) malloc(sizeof(pthread_t));
-    pthread_t* cpuThreads = (pthread_t*) malloc(sizeof(pthread_t) * NUM_CPUS);
+    //TASKS READ ONLINE ARE ONLY READ ONCE, SO THEY CAN NOT BE SHARED BY A SWEEP.
+    // NOR CAN THEY BE READ BY A FORKED TASK PROCESS, AS SIGINT AND SIGTERM WOULD
+    // STILL BE BLOCKED IN THE SCHEDULER THAT RECEIVES THEM
+    if (online && (multiProcess || numSims > 1))
+    {
+        fprintf(stderr, "ERROR: -i can not be used with -P or more than one simulation.\n");
+        return -1;
+    }
 
-    //EXECUTE THREADS
-    int cpuID[] = {1, 2, 3};
-    pthread_create(taskThread, NULL, task, (void*) taskFile);
-    for (int i = 0; i < NUM_CPUS; i++)
+    //READ THE RANGE TO TUNE THE READY QUEUE WITHIN, IF IT IS TUNED
+    TunerBounds tuning = {MIN_BUFFER_CAP, MAX_TUNED_CAP, 1, DEFAULT_MAX_BATCH};
+    if (batchBounds != NULL && capacityBounds == NULL)
     {
-        pthread_create(&cpuThreads[i], NULL, cpu, &(cpuID[i]));
+        fprintf(stderr, "ERROR: -B can only be used with -A.\n");
+        return -1;
+    }
+    if ((capacityBounds != NULL && !parseBounds(capacityBounds, "Queue capacity", MAX_TUNED_CAP,
+                                                &tuning.minCapacity, &tuning.maxCapacity)) ||
+        (batchBounds != NULL && !parseBounds(batchBounds, "Batch size", MAX_TUNED_CAP,
+                                             &tuning.minBatch, &tuning.maxBatch)))
+    {
+        return -1;
     }
-    printf("Running...\n");
 
-    //JOIN TASK AND CPU THREADS BACK INTO THE MAIN THREAD
-    pthread_join(*taskThread, NULL);
-    for (int i = 0; i < NUM_CPUS; i++)
+    //A TUNED QUEUE STARTS AT THE GIVEN SIZE, MOVED INTO ITS BOUNDS. SIZES MOVED
+    // TO THE SAME ONE WOULD RUN THE SAME SIMULATION INTO THE SAME FILES
+    for (int i = 0; capacityBounds != NULL && i < numSizes; i++)
     {
-        pthread_join(cpuThreads[i], NULL);
+        const int size = bufferSizes[i];
+        bufferSizes[i] = size < tuning.minCapacity ? tuning.minCapacity :
+                         (size > tuning.maxCapacity ? tuning.maxCapacity : size);
+        for (int j = 0; j < i; j++)
+        {
+            if (bufferSizes[j] == bufferSizes[i])
+            {
+                fprintf(stderr, "ERROR: Buffer size %d starts the tuned queue at %d, "
+                        "as does another size given.\n", size, bufferSizes[i]);
+                return -1;
+            }
+        }
+    }
+
+    //READ THE SPEED OF EACH CPU, WHICH ALSO GIVES THE NUMBER OF CPUS IF NOT SET
+    double* speeds = readSpeeds(speedList, speedFile, &numCpus);
+    if (speeds == NULL)
+    {
+        return -1;
+    }
+
+    //PARSE THE TASK FILE ONCE, IT IS SHARED BY EVERY SIMULATION. ONLINE, THE
+    // WORKLOAD IS EMPTY AND THE INPUT IS OPENED BEFORE ANY THREAD IS CREATED
+    TaskStream* stream = NULL;
+    Workload* workload = NULL;
+    if (online)
+    {
+        if ((stream = taskStream_open(taskFile, 0)) != NULL)
+        {
+            workload = workload_create();
+        }
+    }
+    else
+    {
+        workload = workload_load(taskFile);
+    }
+    if (workload == NULL)
+    {
+        free(speeds);
+        return -1;
+    }
+
+    //CREATE A SIMULATION FOR EVERY COMBINATION OF QUEUE SIZE, DISPATCH MODE AND
+    // QUEUE ORDER, EACH WITH ITS OWN OUTPUT FILES NAMED AFTER WHAT IS COMPARED
+    Simulation* sims[MAX_SIMULATIONS];
+    for (int i = 0; i < numSims; i++)
+    {
+        SimulationConfig config;
+        config.bufferSize = bufferSizes[i / (numModes * numOrders)];
+        config.dispatch = (DispatchMode) dispatchModes[i / numOrders % numModes];
+        config.order = (BufferOrder) orders[i % numOrders];
+        config.admissionControl = admissionControl;
+        config.multiProcess = multiProcess;
+        config.verbosity = (LogLevel) level;
+        config.sampleEvery = sampleEvery;
+        //EFT ONLY EVER INSERTS ONE TASK AT A TIME
+        config.adaptive = capacityBounds != NULL;
+        config.tuning = tuning;
+        if (config.dispatch == DISPATCH_EFT)
+        {
+            config.tuning.minBatch = 1;
+            config.tuning.maxBatch = 1;
+        }
+        config.numCpus = numCpus;
+        config.speeds = speeds;
+        //NEVER USE MORE OS THREADS THAN THERE ARE CPUS TO RUN ON THEM
+        config.numWorkerThreads = numWorkerThreads < numCpus ? numWorkerThreads : numCpus;
+
+        char suffix[MAX_SUFFIX_SIZE] = "";
+        char logFile[MAX_FILENAME_SIZE], simTraceFile[MAX_FILENAME_SIZE];
+        if (numSizes > 1)
+        {
+            snprintf(suffix, sizeof(suffix), "_q%d", config.bufferSize);
+        }
+        if (numModes > 1)
+        {
+            strncat(suffix, "_", sizeof(suffix) - strlen(suffix) - 1);
+            strncat(suffix, DISPATCH_NAMES[config.dispatch], sizeof(suffix) - strlen(suffix) - 1);
+        }
+        if (numOrders > 1)
+        {
+            strncat(suffix, "_", sizeof(suffix) - strlen(suffix) - 1);
+            strncat(suffix, ORDER_NAMES[config.order], sizeof(suffix) - strlen(suffix) - 1);
+        }
+        snprintf(logFile, sizeof(logFile), "simulation_log%s", suffix);
+        if (traceFile != NULL)
+        {
+            snprintf(simTraceFile, sizeof(simTraceFile), "%s%s", traceFile, suffix);
+        }
+
+        sims[i] = simulation_create(workload, &config, logFile,
+                                    traceFile != NULL ? simTraceFile : NULL);
+        if (sims[i] == NULL)
+        {
+            for (int j = 0; j < i; j++)
+            {
+                simulation_free(sims[j]);
+            }
+            if (stream != NULL)
+            {
+                taskStream_close(stream);
+            }
+            workload_free(workload);
+            free(speeds);
+            return -1;
+        }
+        //TASK IDS FROM SEVERAL SIMULATIONS WOULD BE INTERLEAVED, SO ONLY PRINT FOR ONE
+        sims[i]->printTaskIDs = numSims == 1;
+    }
+    sims[0]->stream = stream;
+
+    //RUN EVERY SIMULATION AT THE SAME TIME, EACH ON ITS OWN THREAD
+    printf("Running...\n");
+    if (numSims == 1)
+    {
+        runSimulation(sims[0]);
+    }
+    else
+    {
+        pthread_t simThreads[MAX_SIMULATIONS];
+        for (int i = 0; i < numSims; i++)
+        {
+            pthread_create(&simThreads[i], NULL, runSimulation, sims[i]);
+        }
+        for (int i = 0; i < numSims; i++)
+        {
+            pthread_join(simThreads[i], NULL);
+        }
+        printSweepSummary(sims, numSims);
     }
     printf("Done.\n");
 
+    //FREE RESOURCES
+    for (int i = 0; i < numSims; i++)
+    {
+        simulation_free(sims[i]);
+    }
+    workload_free(workload);
+    free(speeds);
+
+    return 0;
+}
+
+void* runSimulation(void* simulation)
+{
+    Simulation* sim = (Simulation*) simulation;
+    const SimulationConfig* config = &sim->config;
+    long long startNs = getTimeNanos();
+
+    //CREATE THREADS
+    pthread_t* taskThread = (pthread_t*) malloc(sizeof(pthread_t));
+    pthread_t* cpuThreads = (pthread_t*) malloc(sizeof(pthread_t) * config->numCpus);
+    CpuArgs* cpuArgs = (CpuArgs*) malloc(sizeof(CpuArgs) * config->numCpus);
+    for (int i = 0; i < config->numCpus; i++)
+    {
+        cpuArgs[i].sim = sim;
+        cpuArgs[i].cpuID = i + 1;
+        cpuArgs[i].ownThread = false;
+    }
+
+    //EXECUTE THE TASK AND CPUS AS PROCESSES, WHICH HAVE ALL FINISHED ONCE THIS RETURNS
+    if (config->multiProcess)
+    {
+        runProcesses(sim, cpuArgs);
+    }
+    else
+    {
+        //EXECUTE THREADS
+        pthread_create(taskThread, NULL, task, sim);
+        if (config->numWorkerThreads > 0)
+        {
+            //RUN THE CPUS AS COROUTINES, THIS RETURNS ONCE THEY HAVE ALL FINISHED. A
+            // CPU THAT CAN NOT BE GIVEN A COROUTINE RUNS ON ITS OWN THREAD INSTEAD
+            CoroutinePool* pool = coroutinePool_create(config->numWorkerThreads,
+                                                       registerWorkerThread, sim);
+            for (int i = 0; i < config->numCpus; i++)
+            {
+                cpuArgs[i].ownThread = !coroutinePool_spawn(pool, cpuCoroutine, &cpuArgs[i]);
+                if (cpuArgs[i].ownThread)
+                {
+                    pthread_create(&cpuThreads[i], NULL, cpu, &cpuArgs[i]);
+                }
+            }
+            coroutinePool_run(pool);
+            coroutinePool_free(pool);
+        }
+        else
+        {
+            for (int i = 0; i < config->numCpus; i++)
+            {
+                cpuArgs[i].ownThread = true;
+                pthread_create(&cpuThreads[i], NULL, cpu, &cpuArgs[i]);
+            }
+        }
+
+        //JOIN TASK AND CPU THREADS BACK INTO THIS THREAD
+        pthread_join(*taskThread, NULL);
+        for (int i = 0; i < config->numCpus; i++)
+        {
+            if (cpuArgs[i].ownThread)
+            {
+                pthread_join(cpuThreads[i], NULL);
+            }
+        }
+    }
+    sim->elapsedSecs = (getTimeNanos() - startNs) / 1e9;
+
     //LOG FINAL VALUES
-    fprintf(sim_log->file, "Number of tasks: %d\n", cpu_info->num_tasks);
-    fprintf(sim_log->file, "Average waiting time: %.3f\n",
-            (float) cpu_info->total_waiting_time / (float) cpu_info->num_tasks);
-    fprintf(sim_log->file, "Average turnaround time: %.3f\n",
-            (float) cpu_info->total_turnaround_time / (float) cpu_info->num_tasks);
+    const SchedulerInfo* info = sim->info;
+    FILE* logFile = sim->log->file;
+    fprintf(logFile, "Number of tasks: %d\n", info->num_tasks);
+    fprintf(logFile, "Average waiting time: %.3f\n",
+            (float) info->total_waiting_time / (float) info->num_tasks);
+    fprintf(logFile, "Average turnaround time: %.3f\n",
+            (float) info->total_turnaround_time / (float) info->num_tasks);
+
+    //LOG HOW BUSY EACH CPU WAS OVER THE WHOLE RUN
+    fprintf(logFile, "Dispatch: %s\n", DISPATCH_NAMES[config->dispatch]);
+    fprintf(logFile, "Makespan: %.3f\n", sim->elapsedSecs);
+    for (int i = 0; i < config->numCpus; i++)
+    {
+        fprintf(logFile, "CPU-%d speed %.2f: %d tasks, utilization %.1f%%\n",
+                i + 1, config->speeds[i], info->cpu_tasks[i],
+                100.0 * info->cpu_busy_secs[i] / sim->elapsedSecs);
+    }
+    //TASKS READ ONLINE WERE NOT KNOWN UP FRONT, SO CAN NOT BE ESTIMATED
+    if (sim->stream == NULL)
+    {
+        fprintf(logFile, "Estimated makespan with fcfs: %.3f\n",
+                simulation_estimateMakespan(sim->workload, config, DISPATCH_FCFS) *
+                BURST_UNIT_USECS / 1e6);
+        fprintf(logFile, "Estimated makespan with eft: %.3f\n",
+                simulation_estimateMakespan(sim->workload, config, DISPATCH_EFT) *
+                BURST_UNIT_USECS / 1e6);
+    }
+
+    //LOG HOW MANY TASKS MET THEIR DEADLINES
+    fprintf(logFile, "Queue order: %s\n", ORDER_NAMES[config->order]);
+    fprintf(logFile, "Tasks with deadlines completed: %d\n", info->num_deadline_tasks);
+    fprintf(logFile, "Deadline misses: %d (%.1f%%)\n", info->num_missed,
+            info->num_deadline_tasks > 0 ?
+            100.0 * info->num_missed / info->num_deadline_tasks : 0.0);
+    fprintf(logFile, "Tasks shed: %d\n", info->num_shed);
+    fprintf(logFile, "Goodput: %.3f tasks/s\n", goodput(sim));
+    fprintf(logFile, "Verbosity: %s", VERBOSITY_NAMES[config->verbosity]);
+    if (config->verbosity == LOG_EVENT && config->sampleEvery > 1)
+    {
+        fprintf(logFile, ", events of 1 in %d tasks", config->sampleEvery);
+    }
+    fprintf(logFile, "\n");
+
+    //LOG HOW WELL THE CPUS RAN IN PARALLEL. WITH DEPENDENCIES THE CRITICAL PATH
+    // BOUNDS THE MAKESPAN HOWEVER MANY CPUS THERE ARE, WITHOUT THEM THERE IS NO
+    // BOUND WORTH REPORTING. TASKS READ ONLINE NEVER HAVE DEPENDENCIES
+    const Workload* workload = sim->workload;
+    double busySecs = 0;
+    for (int i = 0; i < config->numCpus; i++)
+    {
+        busySecs += info->cpu_busy_secs[i];
+    }
+    if (workload->hasDeps)
+    {
+        fprintf(logFile, "Critical path: %.3f\n", workload->criticalPath * BURST_UNIT_USECS / 1e6);
+        fprintf(logFile, "Parallelism: %.2f achieved on %d CPUs, at most %.2f allowed by the dependencies\n",
+                busySecs / sim->elapsedSecs, config->numCpus,
+                workload->criticalPath > 0 ? (double) workload->totalBurst / workload->criticalPath : 0.0);
+    }
+    else
+    {
+        fprintf(logFile, "Parallelism: %.2f achieved on %d CPUs\n",
+                busySecs / sim->elapsedSecs, config->numCpus);
+    }
+    if (!config->multiProcess)
+    {
+        lockStats_log(sim->lockStats, logFile);
+    }
 
     //FREE RESOURCES
-    buffer_free(task_buffer);
-    log_free(sim_log);
-    schedulerInfo_free(cpu_info);
     free(taskThread);
     free(cpuThreads);
+    free(cpuArgs);
 
-    return 0;
+    return NULL;
 }
 
-void* task(void* taskFileName)
+void* task(void* simulation)
 {
-    FILE* taskFile = NULL;
-    char line[MAX_LINE_SIZE + 1];
-    char lines[MAX_NUM_TASKS][MAX_LINE_SIZE + 1];
-    struct tm* currTime;
-    int taskID, taskBurstTime;
-    int tasksInserted = 0;
-    bool lastSetOfTasks, oddNumOfTasks, shouldAddSecondTask;
+    Simulation* sim = (Simulation*) simulation;
+    const SimulationConfig* config = &sim->config;
+    Log* log = sim->log;
+    int tasksInserted = 0, tasksTaken = 0, nextRoot = 0;
 
-    //OPENS THE TASKFILE FOR READING
-    taskFile = fopen((char*) taskFileName, "r");
-    if (taskFile == NULL)
+    lockStats_registerThread(sim->lockStats, "task");
+    trace_nameTrack(sim->trace, TRACE_PRODUCER_TRACK, "task");
+
+    if (config->dispatch == DISPATCH_EFT)
     {
-        perror("ERROR: The task file could not be opened ");
-        buffer_free(task_buffer);
-        log_free(sim_log);
-        schedulerInfo_free(cpu_info);
-        exit(-1);
+        //SEND EACH TASK TO THE CPU ESTIMATED TO FINISH IT FIRST, GIVEN WHEN THE
+        // WORK ALREADY SENT TO EACH CPU IS ESTIMATED TO FINISH
+        long long* finishNs = calloc(config->numCpus, sizeof(long long));
+        bool* lost = calloc(config->numCpus, sizeof(bool));
+        int numLive = config->numCpus;
+        Task task;
+        while (numLive > 0 && tasksRemain(sim, tasksTaken) && takeReadyTask(sim, &nextRoot, true, &task))
+        {
+            tasksTaken++;
+            //A CPU'S QUEUE IS ONLY CLOSED THIS EARLY IF THE CPU HAS DIED, SO THE
+            // TASK GOES TO THE NEXT BEST CPU UNTIL THERE ARE NONE LEFT
+            bool inserted = false;
+            while (!inserted && numLive > 0)
+            {
+                const long long now = getTimeNanos();
+                int chosen = -1;
+                for (int c = 0; c < config->numCpus; c++)
+                {
+                    finishNs[c] = (finishNs[c] > now ? finishNs[c] : now);
+                    if (!lost[c] && (chosen == -1 ||
+                        finishNs[c] + burstNanos(task.burst, config->speeds[c]) <
+                        finishNs[chosen] + burstNanos(task.burst, config->speeds[chosen])))
+                    {
+                        chosen = c;
+                    }
+                }
+
+                //THE CHOSEN CPU'S ESTIMATE IS ALSO WHEN THE TASK WOULD FINISH
+                const long long estimateNs = finishNs[chosen] + burstNanos(task.burst, config->speeds[chosen]);
+                if (!admitTask(sim, &task, now, estimateNs))
+                {
+                    break;
+                }
+
+                inserted = insertTasks(sim, sim->cpuBuffers[chosen], chosen + 1, &task, 1);
+                if (inserted)
+                {
+                    finishNs[chosen] = estimateNs;
+                    tasksInserted++;
+                    tuneQueues(sim);
+                }
+                else
+                {
+                    lost[chosen] = true;
+                    numLive--;
+                }
+            }
+        }
+        free(finishNs);
+        free(lost);
+    }
+    else
+    {
+        //THE OUTSTANDING WORK IS SHARED BY EVERY CPU, AT THEIR AVERAGE SPEED
+        double totalSpeed = 0;
+        for (int c = 0; c < config->numCpus; c++)
+        {
+            totalSpeed += config->speeds[c];
+        }
+        const double averageSpeed = totalSpeed / config->numCpus;
+
+        //INSERT THE WORKLOAD TWO TASKS AT A TIME, BUT ONLY ONE AT A TIME IF THE
+        // BUFFER HAS A SIZE OF 1, UNLESS THE NUMBER IS BEING TUNED
+        Task* tasks = malloc(sizeof(Task) * (sim->tuner != NULL ? config->tuning.maxBatch : 2));
+        while (tasksRemain(sim, tasksTaken))
+        {
+            const int tasksPerInsert = sim->tuner != NULL ? sim->tuner->batch :
+                                       (sim->buffer->capacity > 1 ? 2 : 1);
+            int numTasks = 0;
+            //COPY EACH ADMITTED TASK OUT OF THE SHARED WORKLOAD, ONLY WAITING
+            // FOR A TASK TO BE RELEASED IF THERE ARE NONE TO INSERT YET
+            while (numTasks < tasksPerInsert && tasksRemain(sim, tasksTaken) &&
+                   takeReadyTask(sim, &nextRoot, numTasks == 0, &tasks[numTasks]))
+            {
+                Task* task = &tasks[numTasks];
+                tasksTaken++;
+
+                const long long now = getTimeNanos();
+                const long long estimateNs = now +
+                    (long long) (atomic_load(sim->outstandingNs) / totalSpeed) +
+                    burstNanos(task->burst, averageSpeed);
+                if (admitTask(sim, task, now, estimateNs))
+                {
+                    numTasks++;
+                }
+            }
+
+            if (numTasks > 0)
+            {
+                //THE QUEUE IS ONLY CLOSED THIS EARLY IF EVERY CPU HAS DIED
+                if (!insertTasks(sim, sim->buffer, 0, tasks, numTasks))
+                {
+                    break;
+                }
+                tasksInserted += numTasks;
+                tuneQueues(sim);
+            }
+        }
+        free(tasks);
     }
 
-    //READS THE WHOLE FILE INTO AN ARRAY
-    int numOfTasks = 0;
-    while (numOfTasks < total_num_tasks)
+    //CLOSE THE BUFFERS SO THE CPU'S STOP ONCE THE REMAINING TASKS ARE DRAINED
+    for (int i = 1; i <= (sim->cpuBuffers != NULL ? config->numCpus : 1); i++)
     {
-        fgets(line, MAX_LINE_SIZE + 1, taskFile);
-        strncpy(lines[numOfTasks++], line, MAX_LINE_SIZE + 1);
+        Buffer* buffer = simulation_cpuBuffer(sim, i);
+        lockStats_lock(&buffer->mutex, LOCK_BUFFER);
+        buffer_close(buffer);
+        lockStats_unlock(&buffer->mutex, LOCK_BUFFER);
     }
-    fclose(taskFile);
-    oddNumOfTasks = total_num_tasks % 2 != 0;
 
-    //READS THE ARRAY TWO TASKS AT A TIME
-    int currentTaskNum = 0;
-    int numOfEmptySpacesNeeded = task_buffer->capacity > 1 ? 2 : 1;
-    while (currentTaskNum < total_num_tasks)
+    //LOG TASK THREAD COMPLETION
+    if (log_wants(log, LOG_CPU))
     {
-        Task* task1 = NULL, * task2 = NULL;
-        //UP TO THE FINAL SET OF TASKS
-        lastSetOfTasks = currentTaskNum > total_num_tasks - 2;
+        lockStats_lock(&log->mutex, LOCK_LOG);
+        fprintf(log->file, "Number of tasks put into Ready-Queue: %d\n", tasksInserted);
+        if (sim->tuner != NULL)
+        {
+            fprintf(log->file, "Tuned to a capacity of %d and batch size of %d, changed in %d of %d epochs\n",
+                    sim->tuner->capacity, sim->tuner->batch, sim->tuner->numChanges,
+                    sim->tuner->numEpochs);
+        }
+        if (sim->stream != NULL)
+        {
+            fprintf(log->file, "Lines read: %d, %d rejected\n", sim->stream->lineNum,
+                    sim->stream->numRejected);
+        }
+        logTime(log->file, "Terminate at", getCurrTime());
+        fprintf(log->file, "\n");
+        lockStats_unlock(&log->mutex, LOCK_LOG);
+    }
+
+    return NULL;
+}
 
-        //A SECOND TASK CANT BE ADDED WHEN THERE IS AN ODD NUMBER OF LINES AND
-        // YOU ARE UP TO THE LAST SET OF TASKS. ALSO YOU CAN ONLY ADD TWO TASKS
-        // IF THE BUFFER HAS A SIZE WHICH IS GREATER THAN 1
-        shouldAddSecondTask = !(lastSetOfTasks && oddNumOfTasks) &&
-                              task_buffer->capacity > 1;
+void runProcesses(Simulation* sim, CpuArgs* cpuArgs)
+{
+    const int numProcesses = sim->config.numCpus + 1;
+    pid_t* pids = malloc(sizeof(pid_t) * numProcesses);
+    int numStarted = 0;
 
-        //PROCESS EACH LINE INTO TASK VARIABLES
-        sscanf(lines[currentTaskNum++], "%d %d", &taskID, &taskBurstTime);
-        task1 = task_create(taskID, taskBurstTime);
-        if (shouldAddSecondTask)
+    //ANYTHING STILL BUFFERED WOULD OTHERWISE BE WRITTEN OUT BY EVERY CHILD TOO
+    fflush(NULL);
+    for (; numStarted < numProcesses; numStarted++)
+    {
+        pids[numStarted] = fork();
+        if (pids[numStarted] == -1)
+        {
+            perror("ERROR: A process could not be created ");
+            break;
+        }
+        if (pids[numStarted] == 0)
         {
-            sscanf(lines[currentTaskNum++], "%d %d", &taskID, &taskBurstTime);
-            task2 = task_create(taskID, taskBurstTime);
+            //THE CHILD IS THE TASK THREAD OR ONE CPU, THEN HANDS BACK ITS OWN
+            // COPY OF THE STATISTICS THROUGH ITS SLOT
+            if (numStarted == 0)
+            {
+                task(sim);
+            }
+            else
+            {
+                cpu(&cpuArgs[numStarted - 1]);
+            }
+            schedulerInfo_merge(sim->processInfo[numStarted], sim->info);
+            //THE LOCK STATISTICS ARE LOGGED BY EACH PROCESS FOR ITSELF
+            if (log_wants(sim->log, LOG_CPU))
+            {
+                lockStats_lock(&sim->log->mutex, LOCK_LOG);
+                lockStats_log(sim->lockStats, sim->log->file);
+                lockStats_unlock(&sim->log->mutex, LOCK_LOG);
+            }
+            fflush(NULL);
+            _exit(EXIT_SUCCESS);
         }
+    }
 
-        //OBTAIN LOCK ON THE BUFFER
-        pthread_mutex_lock(&task_buffer->mutex);
-        //WAIT UNTIL THE BUFFER HAS AT LEAST THE FREE SLOTS REQUIRED
-        while (buffer_numOfEmptySpaces(task_buffer) < numOfEmptySpacesNeeded)
+    //WITHOUT EVERY PROCESS THE OTHERS MAY NEVER FINISH, SO STOP THEM
+    if (numStarted < numProcesses)
+    {
+        for (int i = 0; i < numStarted; i++)
         {
-            //WHILE WAITING FOR REQUIRED EMPTY SLOTS, GIVE UP LOCK ON THE BUFFER
-            pthread_cond_wait(&task_buffer->emptyCond, &task_buffer->mutex);
+            kill(pids[i], SIGKILL);
         }
+    }
 
-        //RETRIEVE AND STORE ARRIVAL TIME FOR BOTH TASKS
-        currTime = getCurrTime();
-        memcpy(task1->arrivalT, currTime, sizeof(struct tm));
-        if (shouldAddSecondTask)
+    //REAP EACH PROCESS AS IT EXITS, ADDING UP THE STATISTICS OF THOSE THAT
+    // FINISHED, SO THAT ONE DYING IS CLEANED UP AFTER WHILE THE REST RUN
+    int cpusRunning = numStarted - 1;
+    for (int numReaped = 0; numReaped < numStarted;)
+    {
+        int status;
+        const pid_t pid = waitpid(-1, &status, 0);
+        if (pid == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("ERROR: Could not wait for a process ");
+            break;
+        }
+        int i = 0;
+        while (i < numStarted && pids[i] != pid)
         {
-            memcpy(task2->arrivalT, currTime, sizeof(struct tm));
+            i++;
         }
+        if (i == numStarted)
+        {
+            continue;
+        }
+        numReaped++;
+        cpusRunning -= i > 0;
 
-        //INSERT TWO TASKS INTO THE BUFFER AT A TIME
-        buffer_insertNext(task_buffer, task1);
-        tasksInserted++;
-        if (shouldAddSecondTask)
+        if (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS)
+        {
+            schedulerInfo_merge(sim->info, sim->processInfo[i]);
+        }
+        else if (numStarted == numProcesses)
         {
-            buffer_insertNext(task_buffer, task2);
-            tasksInserted++;
+            char name[MAX_THREAD_NAME_SIZE];
+            snprintf(name, sizeof(name), i == 0 ? "task" : "CPU-%d", i);
+            const int tasksLost = recoverProcess(sim, i, cpusRunning);
+            fprintf(stderr, "ERROR: The %s process ended abnormally, its statistics are lost.\n", name);
+            lockStats_lock(&sim->log->mutex, LOCK_LOG);
+            fprintf(sim->log->file, "The %s process ended abnormally", name);
+            if (i > 0)
+            {
+                fprintf(sim->log->file, ", %d tasks were given up on", tasksLost);
+            }
+            fprintf(sim->log->file, ".\n\n");
+            lockStats_unlock(&sim->log->mutex, LOCK_LOG);
         }
+    }
+    free(pids);
+}
 
-        //LOG ARRIVAL TIME OF BOTH TASKS TO FILE
-        pthread_mutex_lock(&sim_log->mutex);
-        logArrivalTime(sim_log->file, task1->id, task1->burst, task1->arrivalT);
-        if (shouldAddSecondTask)
+int recoverProcess(Simulation* sim, int process, int cpusRunning)
+{
+    int tasksLost = 0;
+    if (process == 0)
+    {
+        //THE CPUS STOP ONCE THEY HAVE DRAINED WHAT THE TASK PROCESS INSERTED
+        for (int i = 1; i <= (sim->cpuBuffers != NULL ? sim->config.numCpus : 1); i++)
         {
-            logArrivalTime(sim_log->file, task2->id, task2->burst, task2->arrivalT);
+            Buffer* buffer = simulation_cpuBuffer(sim, i);
+            lockStats_lock(&buffer->mutex, LOCK_BUFFER);
+            buffer_close(buffer);
+            lockStats_unlock(&buffer->mutex, LOCK_BUFFER);
         }
-        pthread_mutex_unlock(&sim_log->mutex);
+        return tasksLost;
+    }
 
-        //RELEASE THE BUFFER LOCK AND SIGNALS ALL CPU'S THAT A FULL SLOT IS IN THE BUFFER
-        pthread_mutex_unlock(&task_buffer->mutex);
-        pthread_cond_broadcast(&task_buffer->fullCond);
+    //THE TASK THE CPU WAS RUNNING WILL NEVER COMPLETE, SO NEITHER CAN ANY TASK
+    // THAT DEPENDS ON IT. RELEASING THEM AS SHED STOPS THE TASK PROCESS FROM
+    // WAITING ON THEM
+    const int seq = atomic_exchange(&sim->running[process - 1], -1);
+    if (seq != -1)
+    {
+        atomic_fetch_sub(sim->outstandingNs, burstNanos(sim->workload->tasks[seq].burst, 1));
+        simulation_releaseDependents(sim, seq, true);
+        tasksLost++;
     }
 
-    //LOG TASK THREAD COMPLETION
-    pthread_mutex_lock(&sim_log->mutex);
-    fprintf(sim_log->file, "Number of tasks put into Ready-Queue: %d\n", tasksInserted);
-    logTime(sim_log->file, "Terminate at", getCurrTime());
-    fprintf(sim_log->file, "\n");
-    pthread_mutex_unlock(&sim_log->mutex);
+    //A QUEUE WITH NO CPU LEFT TO TAKE FROM IT IS EMPTIED THE SAME WAY AND
+    // CLOSED, SO THAT THE TASK PROCESS STOPS INSERTING INTO IT
+    if (sim->cpuBuffers != NULL || cpusRunning == 0)
+    {
+        Buffer* buffer = simulation_cpuBuffer(sim, process);
+        Task task;
+        lockStats_lock(&buffer->mutex, LOCK_BUFFER);
+        while (buffer_removeNext(buffer, &task))
+        {
+            atomic_fetch_sub(sim->outstandingNs, burstNanos(task.burst, 1));
+            simulation_releaseDependents(sim, task.seq, true);
+            tasksLost++;
+        }
+        buffer_close(buffer);
+        lockStats_unlock(&buffer->mutex, LOCK_BUFFER);
+    }
 
-    pthread_exit(0);
+    return tasksLost;
 }
 
-void* cpu(void* cpuThreadID)
+bool insertTasks(Simulation* sim, Buffer* buffer, int queueID, Task* tasks, int numTasks)
 {
-    Task* task;
-    const int cpuID = *(int*) cpuThreadID;
+    Log* log = sim->log;
+
+    //OBTAIN LOCK ON THE BUFFER
+    lockStats_lock(&buffer->mutex, LOCK_BUFFER);
+    //WAIT UNTIL THE BUFFER HAS AT LEAST THE FREE SLOTS REQUIRED, OR HAS BEEN
+    // CLOSED BECAUSE NO CPU IS LEFT TO TAKE FROM IT
+    const int occupied = buffer->occupied;
+    long long stallStart = getTimeNanos();
+    bool stalled = false;
+    while (buffer_numOfEmptySpaces(buffer) < numTasks && !buffer->closed)
+    {
+        //WHILE WAITING FOR REQUIRED EMPTY SLOTS, GIVE UP LOCK ON THE BUFFER
+        lockStats_wait(&buffer->emptyCond, &buffer->mutex, COND_EMPTY, LOCK_BUFFER);
+        stalled = true;
+    }
+    if (buffer->closed)
+    {
+        lockStats_unlock(&buffer->mutex, LOCK_BUFFER);
+        return false;
+    }
+    long long arrivalNs = getTimeNanos();
+    if (stalled)
+    {
+        trace_span(sim->trace, TRACE_PRODUCER_TRACK, "stall", -1, stallStart, arrivalNs);
+    }
+    if (sim->tuner != NULL)
+    {
+        tuner_record(sim->tuner, occupied, stalled ? arrivalNs - stallStart : 0);
+    }
+
+    //RETRIEVE AND STORE ARRIVAL TIME AND DEADLINE FOR EVERY TASK, THEN INSERT
+    // THEM ALL AT ONCE
+    time_t currTime = getCurrTime();
+    for (int i = 0; i < numTasks; i++)
+    {
+        tasks[i].arrivalT = currTime;
+        if (tasks[i].deadline > 0)
+        {
+            tasks[i].deadlineNs = arrivalNs + burstNanos(tasks[i].deadline, 1);
+        }
+        atomic_fetch_add(sim->outstandingNs, burstNanos(tasks[i].burst, 1));
+        buffer_insertNext(buffer, &tasks[i]);
+        trace_instant(sim->trace, TRACE_PRODUCER_TRACK, "arrival", tasks[i].id, arrivalNs);
+    }
+    traceQueue(sim, queueID, buffer, arrivalNs);
+
+    //LOG ARRIVAL TIME OF EVERY SAMPLED TASK TO FILE, ONLY TAKING THE LOCK IF
+    // THERE IS ONE
+    bool logLocked = false;
+    for (int i = 0; i < numTasks; i++)
+    {
+        if (log_wantsTask(log, tasks[i].seq))
+        {
+            if (!logLocked)
+            {
+                lockStats_lock(&log->mutex, LOCK_LOG);
+                logLocked = true;
+            }
+            logArrivalTime(log->file, tasks[i].id, tasks[i].burst, tasks[i].arrivalT);
+        }
+    }
+    if (logLocked)
+    {
+        lockStats_unlock(&log->mutex, LOCK_LOG);
+    }
+
+    //RELEASE THE BUFFER LOCK AND SIGNALS ALL CPU'S THAT A FULL SLOT IS IN THE BUFFER
+    lockStats_unlock(&buffer->mutex, LOCK_BUFFER);
+    pthread_cond_broadcast(&buffer->fullCond);
+
+    return true;
+}
+
+void* cpu(void* cpuArgs)
+{
+    Simulation* sim = ((CpuArgs*) cpuArgs)->sim;
+    const int cpuID = ((CpuArgs*) cpuArgs)->cpuID;
+    const double speed = sim->config.speeds[cpuID - 1];
+    Buffer* buffer = simulation_cpuBuffer(sim, cpuID);
+    const int queueID = sim->cpuBuffers != NULL ? cpuID : 0;
+    Log* log = sim->log;
+    SchedulerInfo* info = sim->info;
+    const bool isCoroutine = coroutine_isRunning();
+    Task task;
     int tasksCompleted = 0;
+    long long pollNs = MIN_POLL_NS;
+    char threadName[MAX_THREAD_NAME_SIZE];
+
+    snprintf(threadName, sizeof(threadName), "CPU-%d", cpuID);
+    if (!isCoroutine)
+    {
+        lockStats_registerThread(sim->lockStats, threadName);
+    }
+    trace_nameTrack(sim->trace, cpuID, threadName);
 
-    //CPU HAS WORK TO DO UNTIL EVERY TASK HAS BEEN PROCESSED
-    while (schedulerInfo_getNumTasks(cpu_info) < total_num_tasks)
+    //CPU HAS WORK TO DO UNTIL THE BUFFER IS CLOSED AND DRAINED
+    while (true)
     {
         //OBTAIN LOCK ON THE BUFFER
-        pthread_mutex_lock(&task_buffer->mutex);
-        //WAIT UNTIL THE BUFFER HAS AT LEAST ONE TASK IN IT
-        while (buffer_isEmpty(task_buffer))
+        lockStats_lock(&buffer->mutex, LOCK_BUFFER);
+        //WAIT UNTIL THE BUFFER HAS AT LEAST ONE TASK IN IT OR HAS BEEN CLOSED,
+        // TIMING THE WAIT IF THE READY QUEUE IS BEING TUNED
+        const long long idleStart = sim->config.adaptive && buffer_isEmpty(buffer) &&
+                                    !buffer->closed ? getTimeNanos() : 0;
+        while (buffer_isEmpty(buffer) && !buffer->closed)
         {
-            //WHILE WAITING FOR A FULL SLOT, GIVE UP LOCK ON THE BUFFER
-            pthread_cond_wait(&task_buffer->fullCond, &task_buffer->mutex);
+            if (isCoroutine)
+            {
+                //A COROUTINE CAN NOT BLOCK ITS OS THREAD, SO IT GIVES UP THE
+                // LOCK AND SLEEPS, CHECKING LESS OFTEN THE LONGER IT IS IDLE
+                lockStats_unlock(&buffer->mutex, LOCK_BUFFER);
+                coroutine_sleep(pollNs);
+                pollNs = pollNs * 2 < MAX_POLL_NS ? pollNs * 2 : MAX_POLL_NS;
+                lockStats_lock(&buffer->mutex, LOCK_BUFFER);
+            }
+            else
+            {
+                //WHILE WAITING FOR A FULL SLOT, GIVE UP LOCK ON THE BUFFER
+                lockStats_wait(&buffer->fullCond, &buffer->mutex, COND_FULL, LOCK_BUFFER);
+            }
+        }
+        pollNs = MIN_POLL_NS;
+        if (idleStart != 0)
+        {
+            atomic_fetch_add(sim->idleNs, getTimeNanos() - idleStart);
         }
 
-        //REMOVE TASK FROM BUFFER
-        task = buffer_removeNext(task_buffer);
+        //REMOVE TASK FROM BUFFER, NOTHING TO REMOVE MEANS IT IS CLOSED AND DRAINED
+        if (!buffer_removeNext(buffer, &task))
+        {
+            lockStats_unlock(&buffer->mutex, LOCK_BUFFER);
+            break;
+        }
+        atomic_store(&sim->running[cpuID - 1], task.seq);
 
         //RETRIEVE AND STORE SERVICE TIME FOR THE TASK
-        memcpy(task->serviceT, getCurrTime(), sizeof(struct tm));
+        task.serviceT = getCurrTime();
+        long long serviceNs = getTimeNanos();
+        traceQueue(sim, queueID, buffer, serviceNs);
 
-        //LOG SERVICE TIME TO FILE
-        pthread_mutex_lock(&sim_log->mutex);
-        logServiceTime(sim_log->file, cpuID, task->id, task->arrivalT, task->serviceT);
-        pthread_mutex_unlock(&sim_log->mutex);
+        //LOG SERVICE TIME TO FILE IF THE TASK IS SAMPLED
+        const bool logTask = log_wantsTask(log, task.seq);
+        if (logTask)
+        {
+            lockStats_lock(&log->mutex, LOCK_LOG);
+            logServiceTime(log->file, cpuID, task.id, task.arrivalT, task.serviceT);
+            lockStats_unlock(&log->mutex, LOCK_LOG);
+        }
 
         //RELEASE THE BUFFER LOCK AND SIGNAL THAT AN EMPTY SLOT IS IN THE BUFFER
-        pthread_mutex_unlock(&task_buffer->mutex);
-        pthread_cond_signal(&task_buffer->emptyCond);
+        lockStats_unlock(&buffer->mutex, LOCK_BUFFER);
+        pthread_cond_signal(&buffer->emptyCond);
 
-        //UPDATE SHARED VALUES
-        pthread_mutex_lock(&cpu_info->mutex);
-        (cpu_info->num_tasks)++; //HAS TO BE UPDATED BEFORE THE CPU BURST
-        pthread_mutex_unlock(&cpu_info->mutex);
-
-        //CPU BURST
-        usleep((__useconds_t) (task->burst * 1000000 / 5));
+        //CPU BURST, SCALED BY THE SPEED OF THIS CPU
+        if (isCoroutine)
+        {
+            coroutine_sleep(burstNanos(task.burst, speed));
+        }
+        else
+        {
+            usleep((__useconds_t) (burstNanos(task.burst, speed) / 1000));
+        }
 
         //RETRIEVE AND STORE COMPLETION TIME FOR THE TASK
-        memcpy(task->completionT, getCurrTime(), sizeof(struct tm));
+        task.completionT = getCurrTime();
+        long long completionNs = getTimeNanos();
+        trace_span(sim->trace, cpuID, "service", task.id, serviceNs, completionNs);
 
-        //LOG COMPLETION TIME TO FILE
-        pthread_mutex_lock(&sim_log->mutex);
-        logCompletionTime(sim_log->file, cpuID, task->id, task->arrivalT, task->completionT);
-        pthread_mutex_unlock(&sim_log->mutex);
+        //LOG COMPLETION TIME TO FILE IF THE TASK IS SAMPLED
+        if (logTask)
+        {
+            lockStats_lock(&log->mutex, LOCK_LOG);
+            logCompletionTime(log->file, cpuID, task.id, task.arrivalT, task.completionT);
+            lockStats_unlock(&log->mutex, LOCK_LOG);
+        }
 
         //UPDATE SHARED VALUES
-        pthread_mutex_lock(&cpu_info->mutex);
-        cpu_info->total_waiting_time += timeDiffSecs(task->arrivalT, task->serviceT);
-        cpu_info->total_turnaround_time += timeDiffSecs(task->arrivalT, task->completionT);
-        pthread_mutex_unlock(&cpu_info->mutex);
+        atomic_fetch_sub(sim->outstandingNs, burstNanos(task.burst, 1));
+        lockStats_lock(&info->mutex, LOCK_INFO);
+        (info->num_tasks)++;
+        if (task.deadline > 0)
+        {
+            info->num_deadline_tasks++;
+            info->num_missed += completionNs > task.deadlineNs;
+        }
+        info->total_waiting_time += timeDiffSecs(task.arrivalT, task.serviceT);
+        info->total_turnaround_time += timeDiffSecs(task.arrivalT, task.completionT);
+        info->cpu_tasks[cpuID - 1]++;
+        info->cpu_busy_secs[cpuID - 1] += (completionNs - serviceNs) / 1e9;
+        lockStats_unlock(&info->mutex, LOCK_INFO);
+
+        //LET THE TASK THREAD INSERT ANY TASK THAT WAS ONLY WAITING ON THIS ONE
+        simulation_releaseDependents(sim, task.seq, false);
+        atomic_store(&sim->running[cpuID - 1], -1);
 
         tasksCompleted++;
-        printf("%d\n", task->id);
-        task_free(task);
+        if (sim->printTaskIDs)
+        {
+            printf("%d\n", task.id);
+        }
     }
 
     //LOG CPU TERMINATION
-    pthread_mutex_lock(&sim_log->mutex);
-    fprintf(sim_log->file, "CPU-%d terminates after servicing %d tasks.\n\n",
-            cpuID, tasksCompleted);
-    pthread_mutex_unlock(&sim_log->mutex);
+    if (log_wants(log, LOG_CPU))
+    {
+        lockStats_lock(&log->mutex, LOCK_LOG);
+        fprintf(log->file, "CPU-%d terminates after servicing %d tasks.\n\n",
+                cpuID, tasksCompleted);
+        lockStats_unlock(&log->mutex, LOCK_LOG);
+    }
+
+    return NULL;
+}
+
+void tuneQueues(Simulation* sim)
+{
+    Tuner* tuner = sim->tuner;
+    if (tuner == NULL)
+    {
+        return;
+    }
+    const long long now = getTimeNanos();
+    if (!tuner_epochEnded(tuner, now))
+    {
+        return;
+    }
+
+    //EVERY EPOCH IS LOGGED WITH WHAT EACH THREAD DID, IF AT ALL
+    const bool logged = log_wants(sim->log, LOG_CPU);
+    if (logged)
+    {
+        lockStats_lock(&sim->log->mutex, LOCK_LOG);
+    }
+    const bool changed = tuner_decide(tuner, now, atomic_load(sim->idleNs), sim->config.numCpus,
+                                      logged ? sim->log->file : NULL);
+    if (logged)
+    {
+        lockStats_unlock(&sim->log->mutex, LOCK_LOG);
+    }
+
+    //ONLY THE TASK THREAD READS THE LIMIT, SO IT IS CHANGED WITHOUT THE LOCK
+    for (int i = 1; changed && i <= (sim->cpuBuffers != NULL ? sim->config.numCpus : 1); i++)
+    {
+        buffer_setLimit(simulation_cpuBuffer(sim, i), tuner->capacity);
+    }
+}
+
+bool tasksRemain(const Simulation* const sim, int tasksTaken)
+{
+    if (sim->stream != NULL)
+    {
+        return !taskStream_hasEnded(sim->stream);
+    }
+    return tasksTaken < sim->workload->numTasks;
+}
+
+bool takeReadyTask(Simulation* sim, int* nextRoot, bool wait, Task* task)
+{
+    //TASKS READ ONLINE HAVE NO DEPENDENCIES, SO ARE READY AS SOON AS THEY ARRIVE
+    if (sim->stream != NULL)
+    {
+        return taskStream_next(sim->stream, task, wait);
+    }
+
+    const Workload* workload = sim->workload;
+    while (true)
+    {
+        //TASKS RELEASED BY A COMPLETED TASK GO FIRST, THEN THOSE WITH NO
+        // DEPENDENCIES IN THE ORDER OF THE TASK FILE
+        int index = simulation_popReleased(sim);
+        while (index == -1 && *nextRoot < workload->numTasks)
+        {
+            if (workload->numDeps[*nextRoot] == 0)
+            {
+                index = *nextRoot;
+            }
+            (*nextRoot)++;
+        }
+        if (index != -1)
+        {
+            *task = workload->tasks[index];
+            return true;
+        }
+        if (!wait)
+        {
+            return false;
+        }
+
+        //EVERY REMAINING TASK IS WAITING ON ONE BEING RUN BY A CPU
+        sem_wait(sim->released);
+    }
+}
+
+bool admitTask(Simulation* sim, const Task* const task, long long now, long long estimateNs)
+{
+    const bool dependencyShed = task->seq < sim->workload->numTasks &&
+                                atomic_load(&sim->depShed[task->seq]);
+    if (!dependencyShed && (!sim->config.admissionControl || task->deadline == 0 ||
+        estimateNs <= now + burstNanos(task->deadline, 1)))
+    {
+        return true;
+    }
+
+    //THE TASK CAN NOT MEET ITS DEADLINE, OR CAN NEVER RUN, SO IT IS NEVER
+    // INSERTED AND NEITHER ARE THE TASKS THAT DEPEND ON IT
+    lockStats_lock(&sim->info->mutex, LOCK_INFO);
+    sim->info->num_shed++;
+    lockStats_unlock(&sim->info->mutex, LOCK_INFO);
+
+    if (log_wantsTask(sim->log, task->seq))
+    {
+        lockStats_lock(&sim->log->mutex, LOCK_LOG);
+        if (dependencyShed)
+        {
+            fprintf(sim->log->file, "Task #%d: %d\nShed, a task it depends on was shed\n\n",
+                    task->id, task->burst);
+        }
+        else
+        {
+            fprintf(sim->log->file, "Task #%d: %d\nShed, it can not meet its deadline of %d\n\n",
+                    task->id, task->burst, task->deadline);
+        }
+        lockStats_unlock(&sim->log->mutex, LOCK_LOG);
+    }
+    trace_instant(sim->trace, TRACE_PRODUCER_TRACK, "shed", task->id, now);
+    simulation_releaseDependents(sim, task->seq, true);
+
+    return false;
+}
+
+double goodput(const Simulation* const sim)
+{
+    return (sim->info->num_tasks - sim->info->num_missed) / sim->elapsedSecs;
+}
+
+long long burstNanos(int burst, double speed)
+{
+    return (long long) (burst * BURST_UNIT_USECS * 1000.0 / speed);
+}
+
+void traceQueue(Simulation* sim, int queueID, const Buffer* const buffer, long long timeNs)
+{
+    if (sim->trace == NULL)
+    {
+        return;
+    }
+
+    char name[MAX_THREAD_NAME_SIZE + 16] = "Ready-Queue";
+    if (queueID > 0)
+    {
+        snprintf(name, sizeof(name), "Ready-Queue CPU-%d", queueID);
+    }
+    trace_counter(sim->trace, name, buffer->occupied, timeNs);
+}
+
+void cpuCoroutine(void* cpuArgs)
+{
+    cpu(cpuArgs);
+}
+
+void registerWorkerThread(int threadNum, void* simulation)
+{
+    char threadName[MAX_THREAD_NAME_SIZE];
+    snprintf(threadName, sizeof(threadName), "OS-thread-%d", threadNum);
+    lockStats_registerThread(((Simulation*) simulation)->lockStats, threadName);
+}
+
+bool parseBounds(const char* const value, const char* const name, int max, int* min, int* upper)
+{
+    char* endPtr;
+    char* maxPtr = NULL;
+    const long low = strtol(value, &endPtr, 10);
+    const long high = *endPtr == '-' ? strtol(endPtr + 1, &maxPtr, 10) : 0;
+    if (endPtr == value || *endPtr != '-' || maxPtr == endPtr + 1 || *maxPtr != '\0' ||
+        low < 1 || high < low || high > max)
+    {
+        fprintf(stderr, "ERROR: %s must be a range [min]-[max] between 1 and %d.\n", name, max);
+        return false;
+    }
+
+    *min = (int) low;
+    *upper = (int) high;
+    return true;
+}
+
+int parseQueueSizes(const char* const list, int* sizes)
+{
+    int numSizes = 0;
+    const char* start = list;
+    char* endPtr;
+
+    //READ EACH SIZE UP TO THE NEXT COMMA
+    while (true)
+    {
+        const int size = (int) strtol(start, &endPtr, 10);
+        if (endPtr == start || (*endPtr != ',' && *endPtr != '\0') ||
+            size < MIN_BUFFER_CAP || size > MAX_BUFFER_CAP)
+        {
+            fprintf(stderr, "ERROR: Buffer size must be an integer between 1 and 10.\n");
+            return -1;
+        }
+        for (int i = 0; i < numSizes; i++)
+        {
+            if (sizes[i] == size)
+            {
+                fprintf(stderr, "ERROR: Buffer size %d was given more than once.\n", size);
+                return -1;
+            }
+        }
+        if (numSizes == MAX_SWEEP_SIZE)
+        {
+            fprintf(stderr, "ERROR: At most %d buffer sizes can be given.\n", MAX_SWEEP_SIZE);
+            return -1;
+        }
 
-    pthread_exit(0);
+        sizes[numSizes++] = size;
+        if (*endPtr == '\0')
+        {
+            break;
+        }
+        start = endPtr + 1;
+    }
+
+    return numSizes;
+}
+
+int parseModeList(const char* const list, const char* const* names, int numNames,
+                  const char* const what, int* modes)
+{
+    int numModes = 0;
+    const char* start = list;
+
+    //MATCH EACH NAME UP TO THE NEXT COMMA
+    while (true)
+    {
+        size_t length = strcspn(start, ",");
+        int mode = -1;
+        for (int m = 0; m < numNames; m++)
+        {
+            if (strlen(names[m]) == length && strncmp(start, names[m], length) == 0)
+            {
+                mode = m;
+            }
+        }
+        if (mode == -1)
+        {
+            fprintf(stderr, "ERROR: %s must be one of:", what);
+            for (int m = 0; m < numNames; m++)
+            {
+                fprintf(stderr, " %s", names[m]);
+            }
+            fprintf(stderr, ".\n");
+            return -1;
+        }
+        for (int i = 0; i < numModes; i++)
+        {
+            if (modes[i] == mode)
+            {
+                fprintf(stderr, "ERROR: %s %s was given more than once.\n", what, names[mode]);
+                return -1;
+            }
+        }
+
+        modes[numModes++] = mode;
+        if (start[length] == '\0')
+        {
+            break;
+        }
+        start += length + 1;
+    }
+
+    return numModes;
 }
 
-int getNumTasks(const char* const taskFile)
+double* readSpeeds(const char* list, const char* const filename, int* numCpus)
 {
-    FILE* file = NULL;
-    int numTasks = 0;
-    char line[MAX_LINE_SIZE + 1];
+    char* fileContents = NULL;
+
+    //A SPEED FILE HOLDS THE SAME LIST, SEPARATED BY COMMAS OR WHITESPACE
+    if (filename != NULL)
+    {
+        FILE* file = fopen(filename, "r");
+        if (file == NULL)
+        {
+            perror("ERROR: The speed file could not be opened ");
+            return NULL;
+        }
+        //READ INTO A GROWING BUFFER, SO A PIPE THAT CAN NOT BE SEEKED ALSO WORKS
+        size_t size = 0, capacity = 256;
+        fileContents = malloc(capacity);
+        size_t numRead;
+        while ((numRead = fread(fileContents + size, 1, capacity - size - 1, file)) > 0)
+        {
+            size += numRead;
+            if (size == capacity - 1)
+            {
+                capacity *= 2;
+                fileContents = realloc(fileContents, capacity);
+            }
+        }
+        fileContents[size] = '\0';
+        const bool readError = ferror(file);
+        fclose(file);
+        if (readError)
+        {
+            fprintf(stderr, "ERROR: The speed file could not be read.\n");
+            free(fileContents);
+            return NULL;
+        }
+        list = fileContents;
+    }
+
+    //WITHOUT ANY SPEEDS EVERY CPU RUNS AT A SPEED OF 1
+    if (list == NULL)
+    {
+        *numCpus = *numCpus > 0 ? *numCpus : NUM_CPUS;
+        double* speeds = malloc(sizeof(double) * *numCpus);
+        for (int i = 0; i < *numCpus; i++)
+        {
+            speeds[i] = 1;
+        }
+        return speeds;
+    }
 
-    //EXIT PROGRAM IF THE TASKFILE CAN NOT BE OPENED
-    if ((file = fopen(taskFile, "r")) == NULL)
+    int numSpeeds = 0;
+    double* speeds = malloc(sizeof(double) * MAX_CPUS);
+    const char* start = list + strspn(list, ", \t\r\n");
+    while (*start != '\0')
     {
-        perror("ERROR: The task file could not be opened ");
-        exit(-1);
+        char* endPtr;
+        double speed = strtod(start, &endPtr);
+        if (endPtr == start || !isfinite(speed) || speed <= 0 || numSpeeds == MAX_CPUS ||
+            (*endPtr != '\0' && strchr(", \t\r\n", *endPtr) == NULL))
+        {
+            fprintf(stderr, "ERROR: CPU speeds must be a list of positive numbers.\n");
+            free(speeds);
+            free(fileContents);
+            return NULL;
+        }
+        speeds[numSpeeds++] = speed;
+        start = endPtr + strspn(endPtr, ", \t\r\n");
     }
+    free(fileContents);
 
-    //COUNT UP THE NUMBER OF LINES IN THE FILE
-    while (fgets(line, MAX_LINE_SIZE + 1, file) != NULL)
+    //THE NUMBER OF SPEEDS GIVES THE NUMBER OF CPUS, WHICH MUST AGREE WITH -c
+    if (numSpeeds == 0 || (*numCpus > 0 && *numCpus != numSpeeds))
     {
-        numTasks++;
+        fprintf(stderr, "ERROR: One speed must be given for each CPU.\n");
+        free(speeds);
+        return NULL;
     }
-    fclose(file);
+    *numCpus = numSpeeds;
 
-    return numTasks;
+    return speeds;
+}
+
+void printSweepSummary(Simulation** sims, int numSims)
+{
+    printf("%10s %8s %6s %8s %12s %15s %9s %8s %6s %8s\n", "Queue size", "Dispatch",
+           "Order", "Tasks", "Avg waiting", "Avg turnaround", "Makespan", "Missed",
+           "Shed", "Goodput");
+    for (int i = 0; i < numSims; i++)
+    {
+        const SchedulerInfo* info = sims[i]->info;
+        printf("%10d %8s %6s %8d %12.3f %15.3f %9.3f %7.1f%% %6d %8.3f\n",
+               sims[i]->config.bufferSize, DISPATCH_NAMES[sims[i]->config.dispatch],
+               ORDER_NAMES[sims[i]->config.order], info->num_tasks,
+               info->total_waiting_time / info->num_tasks,
+               info->total_turnaround_time / info->num_tasks,
+               sims[i]->elapsedSecs,
+               info->num_deadline_tasks > 0 ?
+               100.0 * info->num_missed / info->num_deadline_tasks : 0.0,
+               info->num_shed, goodput(sims[i]));
+    }
+}
+
+void printUsage()
+{
+    fprintf(stderr, "Usage: ./scheduler [options] [task file name] [queue size]\n");
+    fprintf(stderr, "  A comma separated list of queue sizes, e.g. 1,5,10, runs and compares\n");
+    fprintf(stderr, "  a simulation for each size, dispatch mode and queue order at the same time.\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -t [trace file]  Export a Chrome Trace Event JSON timeline.\n");
+    fprintf(stderr, "  -c [cpus]        The number of simulated CPUs, 3 by default.\n");
+    fprintf(stderr, "  -m [threads]     Run the CPUs as coroutines over this many OS threads.\n");
+    fprintf(stderr, "  -f [speeds]      Comma separated speed factor of each CPU, e.g. 1,1,0.5.\n");
+    fprintf(stderr, "  -F [speed file]  Read the speed factor of each CPU from a file.\n");
+    fprintf(stderr, "  -d [dispatch]    fcfs (default) or eft, or both separated by a comma.\n");
+    fprintf(stderr, "  -q [order]       fifo (default) or edf queue order, or both.\n");
+    fprintf(stderr, "  -a               Shed tasks estimated to miss their deadline.\n");
+    fprintf(stderr, "  -P               Run the task thread and each CPU as separate processes.\n");
+    fprintf(stderr, "  -A [min]-[max]   Tune the queue capacity within this range while running.\n");
+    fprintf(stderr, "  -B [min]-[max]   With -A, the range to tune the tasks inserted at a time in.\n");
+    fprintf(stderr, "  -v [verbosity]   Log the summary only, each cpu, or each event (default).\n");
+    fprintf(stderr, "  -s [n]           Log the events of only one in every n tasks.\n");
+    fprintf(stderr, "  -i               Read tasks online from the task file, a named pipe, or\n");
+    fprintf(stderr, "                   stdin if it is -, until it ends or SIGINT or SIGTERM.\n");
 }
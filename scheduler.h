@@ -4,11 +4,25 @@
  *
  * The tasks to be scheduled are stored in a file that is given by the user
  * through the command line arguments. The task file is to be given in the
- * following format: task# cpu_burst_length
- * For this scheduler there is one thread placing tasks into the buffer and three
- * 'CPU' threads retrieving tasks from the buffer and 'executing' them. All while
- * avoiding the possible race conditions where no progress can occur.
+ * following format: task# cpu_burst_length [deadline]
+ * For this scheduler there is one thread placing tasks into the buffer and, by
+ * default, three 'CPU' threads retrieving tasks from the buffer and 'executing'
+ * them. All while avoiding the possible race conditions where no progress can
+ * occur.
+ *  To simulate a large number of CPUs without a kernel thread for each, the
+ * CPUs can instead be run as coroutines multiplexed over a few OS threads, see
+ * coroutine.h. The same cpu() function is used either way.
  * More details on what each does below.
+ *  The task thread and CPUs can also each be run as a process forked from the
+ * scheduler, communicating only through a Ready Queue in shared memory. A
+ * fault in one process then does not take down the others: the locks they
+ * share are robust, and the scheduler cleans up after any process that dies so
+ * that the rest can still finish. Each process hands its statistics back to the
+ * scheduler when it exits.
+ *  Everything the threads of one run share is kept in a Simulation, see
+ * simulation.h. The task file is parsed once into a Workload, so when several
+ * queue sizes are given a Simulation is run for each of them at the same time
+ * over the same Workload, and their results are compared in one table.
  *
  * @author Lachlan Mackenzie
  * @date 31/03/19
@@ -22,11 +36,21 @@
 #include <memory.h>
 #include <unistd.h>
 #include <stdbool.h>
+#include <signal.h>
+#include <errno.h>
+#include <math.h>
+#include <sys/wait.h>
 #include "buffer.h"
 #include "task.h"
 #include "logFile.h"
 #include "schedulerInfo.h"
 #include "timeUtils.h"
+#include "parseUtils.h"
+#include "lockStats.h"
+#include "trace.h"
+#include "workload.h"
+#include "simulation.h"
+#include "coroutine.h"
 
 //CONSTANTS
 /**
@@ -35,15 +59,32 @@
 #define NUM_ARGS 2
 
 /**
- * The number of CPU threads.
+ * The default number of CPU threads.
  */
 #define NUM_CPUS 3
 
 /**
- * The maximum number of tasks to be scheduled. This is the size of the array
- * of tasks that are read from the given file.
+ * The largest number of simulated CPUs.
  */
-#define MAX_NUM_TASKS 10000
+#define MAX_CPUS 100000
+
+/**
+ * The number of microseconds a CPU spends 'executing' each unit of a task's
+ * burst length.
+ */
+#define BURST_UNIT_USECS 200000
+
+/**
+ * How long a CPU coroutine first waits before checking an empty Ready Queue
+ * again, in nanoseconds. It doubles on each empty check up to the maximum.
+ */
+#define MIN_POLL_NS 1000000LL
+
+/**
+ * The longest a CPU coroutine waits before checking an empty Ready Queue again,
+ * in nanoseconds.
+ */
+#define MAX_POLL_NS 16000000LL
 
 /**
  * The smallest buffer capacity.
@@ -56,82 +97,83 @@
 #define MAX_BUFFER_CAP 10
 
 /**
- * The largest size of each line of the input file in characters. Ten should be
- * plenty.
+ * The largest capacity, and batch size, a tuned Ready Queue can have.
  */
-#define MAX_LINE_SIZE 10
+#define MAX_TUNED_CAP 1024
 
-//GLOBAL VARIABLES
 /**
- * @brief This buffer is used as a Ready Queue for the task and CPU threads to
- * share while avoiding race conditions.
- *
- *  This buffer is used between both the task and CPU threads. The task thread
- * is inserting tasks into the buffer while the CPU threads are removing tasks
- * from the buffer for execution.
- *  The buffer uses a mutex lock to ensure no other thread is accessing the
- * buffer simultaneously, ensuring mutual exclusion.
- *  The task thread is blocked if the buffer does not have enough empty spaces
- * to insert a number of tasks and waits for a signal from the CPU threads when
- * a task is removed from the buffer.
- *  The CPU threads are blocked when the buffer is empty as it cannot execute a
- * task if there are none, these threads are awaiting a signal from the task
- * thread when a task is inserted into the buffer, ready for execution. Ensuring
- * progress is made.
- *
- * @see buffer.h for details on the datatype's structure.
+ * The largest batch size a tuned Ready Queue can have unless set with -B.
  */
-Buffer* task_buffer;
+#define DEFAULT_MAX_BATCH 4
 
 /**
- * @brief This log file is used by all threads to output their respective
- * data that needs to be logged.
- *
- *  This log file is used by both the task threads and the CPU threads.
- *  The task thread logs the arrival time of each task to file and also when the
- * thread has inserted all tasks into the buffer, it logs its termination time
- * and how many tasks were inserted.
- *  The CPU threads log the service time and completion time of the task to file.
- * When the CPU threads terminate, they will also log how many task they have
- * serviced.
- *
- * @see logFile.h for details on the datatype's structure.
-*/
-Log* sim_log;
+ * The largest number of tasks that only one of has its events logged.
+ */
+#define MAX_SAMPLE_EVERY 1000000000
 
 /**
- * @brief This structure is used to store the statistics of the CPU scheduler.
- *
- * This struct is only used by the CPU threads and then the main thread when the
- * CPU's have terminated. Each CPU thread updates these statistics every time a
- * task has been serviced or completed. The only race conditions that can occur
- * are between the CPU threads.
- *
- * @see schedulerInfo.h for details on the datatype's structure.
-*/
-SchedulerInfo* cpu_info;
+ * The most queue sizes, or dispatch modes, that can be compared in one sweep.
+ */
+#define MAX_SWEEP_SIZE 16
+
+/**
+ * The most simulations that can be run in one sweep.
+ */
+#define MAX_SIMULATIONS (MAX_SWEEP_SIZE * 4)
+
+/**
+ * The largest size of a file name built from the log or trace file name.
+ */
+#define MAX_FILENAME_SIZE 256
+
+/**
+ * The largest size of the suffix added to output file names in a sweep.
+ */
+#define MAX_SUFFIX_SIZE 32
+
+/**
+ * The largest size of the name given to a thread in the logs and trace.
+ */
+#define MAX_THREAD_NAME_SIZE 16
 
+//STRUCTS
 /**
- * @brief This variable stores the number of tasks found in the input file.
+ * @brief This CpuArgs struct is used to pass a CPU thread its ID and the
+ * simulation it belongs to.
  *
- * This global variable is used by both the task and cpu threads. The task thread
- * uses this to know when all tasks have been entered into the buffer. The CPU
- * threads use this variable to know when to exit their thread. No race
- * conditions can occur for the global variable as it was only written to when
- * only one thread existed, after that it is only read by the other reads.
-*/
-int total_num_tasks;
+ * @field sim The simulation the CPU thread is part of.
+ * @field cpuID The ID of the CPU, starting from 1.
+ * @field ownThread True if the CPU runs on its own thread, rather than as a
+ * coroutine, and so must be joined.
+ */
+typedef struct
+{
+    Simulation* sim;
+    int cpuID;
+    bool ownThread;
+} CpuArgs;
 
 //FUNCTION PROTOTYPES
+/**
+ * @brief Runs one simulation to completion.
+ *
+ * Creates the task thread and the CPU threads, or processes, waits for them all
+ * to finish and then logs the final statistics. Its signature allows it to be run on its own
+ * thread so that several simulations can run at once.
+ *
+ * @param simulation The Simulation to run.
+ */
+void* runSimulation(void* simulation);
+
 /**
  * @brief The function that the task thread executes on creation. Responsible
  * for inserting tasks into the buffer.
  *
  * See more info on this function in the inline documentation.
  *
- * @param taskFileName The name of the task file to read the task from.
+ * @param simulation The Simulation whose workload is inserted into its buffer.
  */
-void* task(void* taskFileName);
+void* task(void* simulation);
 
 /**
  * @brief The function that the CPU threads execute on creation. It is responsible
@@ -139,19 +181,233 @@ void* task(void* taskFileName);
  *
  * See more info on this function in the inline documentation.
  *
- * @param cpuThreadID 
+ * @param cpuArgs The CpuArgs of the CPU thread.
+ */
+void* cpu(void* cpuArgs);
+
+/**
+ * @brief Runs the task thread and each CPU of a multi-process simulation as its
+ * own forked process, waiting for them all to exit.
+ *
+ * Each child adds its statistics to its slot of the simulation's processInfo
+ * before exiting, and they are added to the simulation's info once it has
+ * exited. Processes are reaped in the order they exit, and one that ends
+ * abnormally is reported, its statistics are left out, and recoverProcess()
+ * lets the others finish without it. If a process can not be created, those
+ * already created are killed.
+ *
+ * @param sim The Simulation to run, created in multi-process mode.
+ * @param cpuArgs The CpuArgs of each CPU, in order of ID.
+ */
+void runProcesses(Simulation* sim, CpuArgs* cpuArgs);
+
+/**
+ * @brief Cleans up after a process of a multi-process simulation that died, so
+ * that the processes still running do not wait forever for it.
+ *
+ * If the task process died, every Ready Queue is closed so the CPUs stop once
+ * they have drained it. If a CPU died, the task it was running is given up on
+ * and its dependents are shed. A Ready Queue with no CPU left to take from it
+ * is emptied the same way and closed, which tells the task process to stop
+ * inserting into it.
+ *
+ * @param sim The Simulation the process belonged to.
+ * @param process 0 for the task process, otherwise the ID of the CPU.
+ * @param cpusRunning The number of CPU processes still running.
+ * @return The number of tasks given up on.
+ */
+int recoverProcess(Simulation* sim, int process, int cpusRunning);
+
+/**
+ * @brief Inserts tasks into a Ready Queue all at once, waiting until it has
+ * room for all of them.
+ *
+ * The arrival time of each task is set and logged as it is inserted, and the
+ * CPUs waiting on the buffer are signalled afterwards. Nothing is inserted if
+ * the buffer is closed, which before the task thread closes it only happens in
+ * multi-process mode once no CPU is left to take from it.
+ *
+ * @param sim The Simulation the buffer belongs to.
+ * @param buffer The Ready Queue to insert the tasks into.
+ * @param queueID 0 for the shared Ready Queue, otherwise the ID of the CPU
+ * whose Ready Queue it is.
+ * @param tasks The tasks to insert.
+ * @param numTasks The number of tasks to insert, at most the buffer's capacity.
+ * @return True if the tasks were inserted, false if the buffer was closed.
  */
-void* cpu(void* cpuThreadID);
+bool insertTasks(Simulation* sim, Buffer* buffer, int queueID, Task* tasks, int numTasks);
 
 /**
- * @brief Calculates the number of tasks from a given file.
+ * @brief Lets the Tuner decide on a new capacity and batch size once each
+ * epoch, applying the capacity to every Ready Queue. Does nothing unless the
+ * Ready Queue is being tuned.
  *
- * The function loops over every line in the file, while incrementing a counter
- * for each line.
+ * Called by the task thread after every insertion.
  *
- * @param taskFile The name of the file the tasks are stored in.
- * @return The number of lines in the given file i.e. the number of tasks.
+ * @param sim The Simulation the task thread belongs to.
+ */
+void tuneQueues(Simulation* sim);
+
+/**
+ * @brief Returns true while the task thread has tasks left to take, either from
+ * the workload or from the input when tasks are read online.
+ *
+ * @param sim The Simulation the task thread belongs to.
+ * @param tasksTaken The number of tasks taken from the workload so far.
+ * @return True if there may be another task to take.
+ */
+bool tasksRemain(const Simulation* const sim, int tasksTaken);
+
+/**
+ * @brief Takes the next task that is ready to be inserted.
+ *
+ * A task is ready once every task it depends on has been completed. Tasks
+ * released by a CPU completing their last dependency are taken first, then
+ * tasks with no dependencies in the order of the task file. Tasks read online
+ * are taken from the input as they arrive.
+ *
+ * @param sim The Simulation the task thread belongs to.
+ * @param nextRoot The position in the workload to look for the next task with
+ * no dependencies from, which is moved past it.
+ * @param wait True to wait for a task to be released if none are ready, which
+ * must only be done while some task has not yet been taken.
+ * @param task Where to copy the task to.
+ * @return True if a task was taken, false if none were ready and wait was false.
+ */
+bool takeReadyTask(Simulation* sim, int* nextRoot, bool wait, Task* task);
+
+/**
+ * @brief Decides whether the task thread should insert a task, or shed it
+ * because it is estimated to miss its deadline.
+ *
+ * Tasks are always admitted unless admission control is on and they have a
+ * deadline, or a task they depend on was shed. A shed task is counted and
+ * logged, and every task that depends on it is shed too.
+ *
+ * @param sim The Simulation the task belongs to.
+ * @param task The task to admit.
+ * @param now The current time, from getTimeNanos(), at which the task would arrive.
+ * @param estimateNs When the task is estimated to be completed, from the work
+ * already waiting for the CPUs and the number and speed of the CPUs.
+ * @return True if the task should be inserted.
+ */
+bool admitTask(Simulation* sim, const Task* const task, long long now, long long estimateNs);
+
+/**
+ * @brief Calculates the goodput of a finished simulation.
+ *
+ * @param sim The Simulation that has finished running.
+ * @return The number of tasks completed without missing a deadline per second.
+ */
+double goodput(const Simulation* const sim);
+
+/**
+ * @brief Calculates how long a CPU of the given speed takes to execute a burst.
+ *
+ * @param burst The burst length of the task.
+ * @param speed The speed factor of the CPU.
+ * @return The time to execute the burst in nanoseconds.
+ */
+long long burstNanos(int burst, double speed);
+
+/**
+ * @brief Writes the occupancy of a Ready Queue to the simulation's trace, if
+ * it has one.
+ *
+ * @param sim The Simulation the buffer belongs to.
+ * @param queueID 0 for the shared Ready Queue, otherwise the ID of the CPU
+ * whose Ready Queue it is.
+ * @param buffer The Ready Queue, whose lock must be held.
+ * @param timeNs The time the occupancy changed, from getTimeNanos().
+ */
+void traceQueue(Simulation* sim, int queueID, const Buffer* const buffer, long long timeNs);
+
+/**
+ * @brief The function that CPU coroutines run, it runs cpu() in a coroutine.
+ *
+ * @param cpuArgs The CpuArgs of the CPU coroutine.
+ */
+void cpuCoroutine(void* cpuArgs);
+
+/**
+ * @brief Registers an OS thread running CPU coroutines for lock statistics.
+ *
+ * Lock statistics are kept per OS thread, so when the CPUs are coroutines their
+ * locks are counted against the OS thread they run on.
+ *
+ * @param threadNum The number of the OS thread in the pool, from 1.
+ * @param simulation The Simulation the thread belongs to.
+ */
+void registerWorkerThread(int threadNum, void* simulation);
+
+/**
+ * @brief Parses a range of positive integers in the format [min]-[max],
+ * printing an error to stderr if it is not a range between 1 and @p max.
+ *
+ * @param value The text of the option.
+ * @param name What the range is of, used in the error.
+ * @param max The largest allowed value.
+ * @param min Where to store the start of the range.
+ * @param upper Where to store the end of the range.
+ * @return True if the range was valid.
+ */
+bool parseBounds(const char* const value, const char* const name, int max, int* min, int* upper);
+
+/**
+ * @brief Parses a comma separated list of queue sizes.
+ *
+ * Prints an error to stderr if a size is not an integer within the valid
+ * range, appears more than once, or there are too many sizes.
+ *
+ * @param list The list of queue sizes, e.g. "1,2,5".
+ * @param sizes The array to store the sizes in, of length MAX_SWEEP_SIZE.
+ * @return The number of sizes in the list, or -1 on an error.
+ */
+int parseQueueSizes(const char* const list, int* sizes);
+
+/**
+ * @brief Parses a comma separated list of named modes, e.g. "fcfs,eft".
+ *
+ * Prints an error to stderr if a name is not recognised or appears more than
+ * once.
+ *
+ * @param list The list of names.
+ * @param names The name of each mode, indexed by the mode's value.
+ * @param numNames The number of modes there are.
+ * @param what What the modes are, used in the error.
+ * @param modes The array to store the mode values in, of length MAX_SWEEP_SIZE.
+ * @return The number of modes in the list, or -1 on an error.
+ */
+int parseModeList(const char* const list, const char* const* names, int numNames,
+                  const char* const what, int* modes);
+
+/**
+ * @brief Reads the speed factor of each CPU from a list or a file.
+ *
+ * The speeds are separated by commas or whitespace. If no speeds are given
+ * every CPU has a speed of 1. Otherwise the number of speeds sets the number of
+ * CPUs, and an error is printed to stderr if it does not match a number of CPUs
+ * that was already set.
+ *
+ * @param list The list of speeds, or NULL.
+ * @param filename The name of a file containing the list of speeds, or NULL.
+ * It is used in place of @p list when given.
+ * @param numCpus The number of CPUs, 0 if not set. Set to the number of speeds.
+ * @return The speed of each CPU on the heap, or NULL on an error.
+ */
+double* readSpeeds(const char* list, const char* const filename, int* numCpus);
+
+/**
+ * @brief Prints a table comparing the results of several simulations to stdout.
+ *
+ * @param sims The simulations that have finished running.
+ * @param numSims The number of simulations.
+ */
+void printSweepSummary(Simulation** sims, int numSims);
+
+/**
+ * @brief Prints how to run the program, and the options it accepts, to stderr.
  */
-int getNumTasks(const char* const taskFile);
+void printUsage();
 
 #endif
@@ -3,28 +3,87 @@
  */
 #include "schedulerInfo.h"
 
-SchedulerInfo* schedulerInfo_create()
+/**
+ * Sets every statistic to zero and initialises the mutex, making it usable
+ * between processes if the struct is in shared memory.
+ */
+static void initInfo(SchedulerInfo* info, int numCpus)
 {
-    SchedulerInfo* info = malloc(sizeof(SchedulerInfo));
+    pthread_mutexattr_t mutexAttr;
+    pthread_mutexattr_init(&mutexAttr);
+    pthread_mutexattr_setpshared(&mutexAttr, info->shared ?
+                                 PTHREAD_PROCESS_SHARED : PTHREAD_PROCESS_PRIVATE);
+
     info->num_tasks = 0;
     info->total_waiting_time = 0;
     info->total_turnaround_time = 0;
-    pthread_mutex_init(&info->mutex, NULL);
+    info->num_deadline_tasks = 0;
+    info->num_missed = 0;
+    info->num_shed = 0;
+    info->num_cpus = numCpus;
+    for (int i = 0; i < numCpus; i++)
+    {
+        info->cpu_tasks[i] = 0;
+        info->cpu_busy_secs[i] = 0;
+    }
+    pthread_mutex_init(&info->mutex, &mutexAttr);
+    pthread_mutexattr_destroy(&mutexAttr);
+}
+
+SchedulerInfo* schedulerInfo_create(int numCpus)
+{
+    SchedulerInfo* info = malloc(sizeof(SchedulerInfo));
+    info->cpu_tasks = calloc(numCpus, sizeof(int));
+    info->cpu_busy_secs = calloc(numCpus, sizeof(double));
+    info->shared = false;
+    initInfo(info, numCpus);
 
     return info;
 }
 
-void schedulerInfo_free(SchedulerInfo* info)
+SchedulerInfo* schedulerInfo_createShared(int numCpus)
 {
-    pthread_mutex_destroy(&info->mutex);
-    free(info);
+    //THE PER-CPU STATISTICS FOLLOW THE STRUCT IN THE SAME SHARED BLOCK
+    SchedulerInfo* info = sharedMem_alloc(sizeof(SchedulerInfo) +
+                                          (sizeof(double) + sizeof(int)) * numCpus);
+    if (info == NULL)
+    {
+        return NULL;
+    }
+    info->cpu_busy_secs = (double*) (info + 1);
+    info->cpu_tasks = (int*) (info->cpu_busy_secs + numCpus);
+    info->shared = true;
+    initInfo(info, numCpus);
+
+    return info;
 }
 
-int schedulerInfo_getNumTasks(SchedulerInfo* info)
+void schedulerInfo_merge(SchedulerInfo* total, const SchedulerInfo* const part)
 {
-    pthread_mutex_lock(&info->mutex);
-    int numTasks = info->num_tasks;
-    pthread_mutex_unlock(&info->mutex);
+    total->num_tasks += part->num_tasks;
+    total->total_waiting_time += part->total_waiting_time;
+    total->total_turnaround_time += part->total_turnaround_time;
+    total->num_deadline_tasks += part->num_deadline_tasks;
+    total->num_missed += part->num_missed;
+    total->num_shed += part->num_shed;
+    for (int i = 0; i < total->num_cpus; i++)
+    {
+        total->cpu_tasks[i] += part->cpu_tasks[i];
+        total->cpu_busy_secs[i] += part->cpu_busy_secs[i];
+    }
+}
 
-    return numTasks;
+void schedulerInfo_free(SchedulerInfo* info)
+{
+    pthread_mutex_destroy(&info->mutex);
+    if (info->shared)
+    {
+        sharedMem_free(info);
+    }
+    else
+    {
+        free(info->cpu_tasks);
+        free(info->cpu_busy_secs);
+        free(info);
+    }
 }
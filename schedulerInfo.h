@@ -11,6 +11,8 @@
 
 #include <pthread.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include "sharedMem.h"
 
 //STRUCTS
 /**
@@ -21,6 +23,16 @@
  * threads.
  * @field total_waiting_time The sum of each tasks waiting time.
  * @field total_turnaround_time The sum of each tasks turnaround time.
+ * @field num_deadline_tasks The number of completed tasks that had a deadline.
+ * @field num_missed The number of completed tasks that missed their deadline.
+ * @field num_shed The number of tasks the task thread dropped because they could
+ * not have met their deadline.
+ * @field num_cpus The number of CPUs the per-CPU statistics are kept for.
+ * @field cpu_tasks The number of tasks each CPU has completed, indexed by the
+ * CPU's ID minus one.
+ * @field cpu_busy_secs The time each CPU has spent executing tasks, indexed by
+ * the CPU's ID minus one.
+ * @field shared True if the statistics are in shared memory.
  * @field mutex The lock that ensures mutual exclusion on threads accessing the
  * information.
  */
@@ -29,6 +41,13 @@ typedef struct
     int num_tasks;
     double total_waiting_time;
     double total_turnaround_time;
+    int num_deadline_tasks;
+    int num_missed;
+    int num_shed;
+    int num_cpus;
+    int* cpu_tasks;
+    double* cpu_busy_secs;
+    bool shared;
     pthread_mutex_t mutex;
 } SchedulerInfo;
 
@@ -36,22 +55,46 @@ typedef struct
 /**
  * @brief Creates a SchedulerInfo and allocates memory to it on the heap.
  *
- * The num_tasks, total_waiting_time, and total_turnaround_time are all
- * initialized to zero and the mutex lock for the struct is also initialised.
+ * The num_tasks, total_waiting_time, total_turnaround_time and the deadline
+ * counts are all initialized to zero, as are the statistics of each CPU, and the mutex lock
+ * for the struct is also initialised.
  *
+ * @param numCpus The number of CPUs to keep statistics for.
  * @return A pointer to the SchedulerInfo struct on the heap.
  */
-SchedulerInfo* schedulerInfo_create();
+SchedulerInfo* schedulerInfo_create(int numCpus);
+
+/**
+ * @brief Creates a SchedulerInfo in shared memory.
+ *
+ * The same as schedulerInfo_create(), except that the struct and its per-CPU
+ * statistics are allocated together with sharedMem_alloc(), so that a process
+ * forked afterwards can hand its statistics back to its parent.
+ *
+ * @param numCpus The number of CPUs to keep statistics for.
+ * @return A pointer to the SchedulerInfo struct in shared memory, or NULL on an
+ * error.
+ */
+SchedulerInfo* schedulerInfo_createShared(int numCpus);
+
+/**
+ * @brief Adds the statistics of one part of a run on to the totals.
+ *
+ * Neither mutex is taken, so nothing may be updating either struct.
+ *
+ * @param total The statistics to add to.
+ * @param part The statistics to add, kept for the same number of CPUs.
+ */
+void schedulerInfo_merge(SchedulerInfo* total, const SchedulerInfo* const part);
 
 /**
  * @brief Deallocates all memory associated with the specified SchedulerInfo.
  *
- * Destroys the mutex lock and free's the whole struct from memory.
+ * Destroys the mutex lock and free's the per-CPU statistics and the whole
+ * struct from memory, or unmaps them if they are in shared memory.
  *
  * @param info The SchedulerInfo to deallocate from memory.
  */
 void schedulerInfo_free(SchedulerInfo* info);
 
-int schedulerInfo_getNumTasks(SchedulerInfo* info);
-
 #endif
@@ -0,0 +1,104 @@
+/**
+ * See documentation in the header file.
+ */
+#include "sharedMem.h"
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+
+/**
+ * The largest size of the name of a shared memory object.
+ */
+#define MAX_SHM_NAME_SIZE 64
+
+/**
+ * Counts the allocations made by this process, to give each a unique name.
+ */
+static atomic_int num_allocations = 0;
+
+void* sharedMem_alloc(size_t size)
+{
+    char name[MAX_SHM_NAME_SIZE];
+    snprintf(name, sizeof(name), "/scheduler-%d-%d", (int) getpid(),
+             atomic_fetch_add(&num_allocations, 1));
+
+    //A NEW OBJECT IS FILLED WITH ZEROES WHEN IT IS GIVEN ITS SIZE
+    const size_t totalSize = size + SHARED_MEM_HEADER_SIZE;
+    const int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd == -1)
+    {
+        perror("ERROR: Shared memory could not be created ");
+        return NULL;
+    }
+    char* memory = MAP_FAILED;
+    if (ftruncate(fd, (off_t) totalSize) == 0)
+    {
+        memory = mmap(NULL, totalSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (memory == MAP_FAILED)
+    {
+        perror("ERROR: Shared memory could not be mapped ");
+    }
+    shm_unlink(name);
+    close(fd);
+    if (memory == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    *(size_t*) memory = totalSize;
+    return memory + SHARED_MEM_HEADER_SIZE;
+}
+
+void sharedMem_free(void* memory)
+{
+    if (memory != NULL)
+    {
+        char* start = (char*) memory - SHARED_MEM_HEADER_SIZE;
+        munmap(start, *(size_t*) start);
+    }
+}
+
+void sharedMem_initMutex(pthread_mutex_t* mutex, bool shared)
+{
+    pthread_mutexattr_t mutexAttr;
+    pthread_mutexattr_init(&mutexAttr);
+    if (shared)
+    {
+        pthread_mutexattr_setpshared(&mutexAttr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&mutexAttr, PTHREAD_MUTEX_ROBUST);
+    }
+    pthread_mutex_init(mutex, &mutexAttr);
+    pthread_mutexattr_destroy(&mutexAttr);
+}
+
+void sharedMem_initCond(pthread_cond_t* cond, bool shared)
+{
+    pthread_condattr_t condAttr;
+    pthread_condattr_init(&condAttr);
+    if (shared)
+    {
+        pthread_condattr_setpshared(&condAttr, PTHREAD_PROCESS_SHARED);
+    }
+    pthread_cond_init(cond, &condAttr);
+    pthread_condattr_destroy(&condAttr);
+}
+
+void sharedMem_lock(pthread_mutex_t* mutex)
+{
+    if (pthread_mutex_lock(mutex) == EOWNERDEAD)
+    {
+        pthread_mutex_consistent(mutex);
+    }
+}
+
+void sharedMem_wait(pthread_cond_t* cond, pthread_mutex_t* mutex)
+{
+    if (pthread_cond_wait(cond, mutex) == EOWNERDEAD)
+    {
+        pthread_mutex_consistent(mutex);
+    }
+}
@@ -0,0 +1,92 @@
+/**
+ * @headerfile sharedMem.h
+ * @brief Functions for allocating memory that is shared with child processes.
+ *
+ * Each allocation is a POSIX shared memory object mapped into this process.
+ * The object's name is removed as soon as it has been mapped, so the memory can
+ * not be opened by any other program and is released once every process that
+ * has it mapped has freed it or exited. Child processes created with fork()
+ * after the allocation see the memory at the same address, so pointers into it
+ * stay valid in every process.
+ *  Locks and conditions placed in shared memory must be initialised with the
+ * PTHREAD_PROCESS_SHARED attribute to work between processes, which
+ * sharedMem_initMutex() and sharedMem_initCond() do. Shared locks are also
+ * robust, so a process that dies while holding one does not leave every other
+ * process waiting for it forever. The next process to take the lock is told
+ * that its owner died, and sharedMem_lock() and sharedMem_wait() then mark it
+ * as usable again and carry on.
+ *
+ * @author Lachlan Mackenzie
+ * @date 18/10/26
+ */
+#ifndef SHAREDMEM_H
+#define SHAREDMEM_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+//CONSTANTS
+/**
+ * The space kept before each allocation to remember its size. It is a whole
+ * cache line so that the memory handed out stays cache line aligned.
+ */
+#define SHARED_MEM_HEADER_SIZE 64
+
+//FUNCTION PROTOTYPES
+/**
+ * @brief Allocates zeroed memory that is shared with any child process forked
+ * after the call.
+ *
+ * An error is printed to stderr if the shared memory can not be created.
+ *
+ * @param size The number of bytes to allocate.
+ * @return A pointer to the cache line aligned memory, or NULL on an error.
+ */
+void* sharedMem_alloc(size_t size);
+
+/**
+ * @brief Unmaps memory returned by sharedMem_alloc() from this process.
+ *
+ * @param memory The memory to unmap, or NULL to do nothing.
+ */
+void sharedMem_free(void* memory);
+
+/**
+ * @brief Initialises a mutex, making it process-shared and robust if it is in
+ * shared memory.
+ *
+ * @param mutex The mutex to initialise.
+ * @param shared True if the mutex is in shared memory.
+ */
+void sharedMem_initMutex(pthread_mutex_t* mutex, bool shared);
+
+/**
+ * @brief Initialises a condition, making it process-shared if it is in shared
+ * memory.
+ *
+ * @param cond The condition to initialise.
+ * @param shared True if the condition is in shared memory.
+ */
+void sharedMem_initCond(pthread_cond_t* cond, bool shared);
+
+/**
+ * @brief Locks a mutex, taking it over if the process that held it died.
+ *
+ * Whatever the dead process was doing while holding the lock is left as it
+ * was, so the data it guards may be partly updated.
+ *
+ * @param mutex The mutex to lock.
+ */
+void sharedMem_lock(pthread_mutex_t* mutex);
+
+/**
+ * @brief Waits on a condition, taking over the mutex when woken if the process
+ * that held it died.
+ *
+ * @param cond The condition to wait on.
+ * @param mutex The mutex held by the caller, released while waiting.
+ */
+void sharedMem_wait(pthread_cond_t* cond, pthread_mutex_t* mutex);
+
+#endif
@@ -0,0 +1,275 @@
+/**
+ * See documentation in the header file.
+ */
+#include "simulation.h"
+
+/**
+ * The counters every thread, or process, of a simulation updates during the
+ * run. They are allocated in one block along with the per-task dependency
+ * state and what each CPU is running, which follow them in the order:
+ * depsLeft, releasedNext, running, depShed.
+ */
+typedef struct
+{
+    atomic_llong outstandingNs;
+    atomic_llong idleNs;
+    atomic_int releasedHead;
+    sem_t released;
+} SharedCounters;
+
+/**
+ * Creates a Ready Queue, in shared memory in multi-process mode.
+ */
+static Buffer* createBuffer(const SimulationConfig* const config)
+{
+    //A TUNED QUEUE HAS ROOM TO GROW TO ITS LARGEST CAPACITY
+    const int capacity = config->adaptive ? config->tuning.maxCapacity : config->bufferSize;
+    Buffer* buffer = config->multiProcess ? buffer_createShared(capacity, config->order) :
+                     buffer_create(capacity, config->order);
+    if (buffer != NULL && config->adaptive)
+    {
+        buffer_setLimit(buffer, config->bufferSize);
+    }
+    return buffer;
+}
+
+/**
+ * Allocates the counters and dependency state, in shared memory in
+ * multi-process mode, and starts every task waiting on all of its dependencies.
+ * Returns false if the shared memory could not be created.
+ */
+static bool createCounters(Simulation* sim)
+{
+    const int numTasks = sim->workload->numTasks;
+    const size_t size = sizeof(SharedCounters) +
+                        (sizeof(atomic_int) + sizeof(int) + sizeof(atomic_bool)) * numTasks +
+                        sizeof(atomic_int) * sim->config.numCpus;
+    SharedCounters* counters = sim->config.multiProcess ? sharedMem_alloc(size) : malloc(size);
+    if (counters == NULL)
+    {
+        return false;
+    }
+
+    sim->outstandingNs = &counters->outstandingNs;
+    sim->idleNs = &counters->idleNs;
+    sim->releasedHead = &counters->releasedHead;
+    sim->released = &counters->released;
+    sim->depsLeft = (atomic_int*) (counters + 1);
+    sim->releasedNext = (int*) (sim->depsLeft + numTasks);
+    sim->running = (atomic_int*) (sim->releasedNext + numTasks);
+    sim->depShed = (atomic_bool*) (sim->running + sim->config.numCpus);
+
+    atomic_init(sim->outstandingNs, 0);
+    atomic_init(sim->idleNs, 0);
+    atomic_init(sim->releasedHead, -1);
+    sem_init(sim->released, sim->config.multiProcess, 0);
+    for (int i = 0; i < numTasks; i++)
+    {
+        atomic_init(&sim->depsLeft[i], sim->workload->numDeps[i]);
+        atomic_init(&sim->depShed[i], false);
+    }
+    for (int i = 0; i < sim->config.numCpus; i++)
+    {
+        atomic_init(&sim->running[i], -1);
+    }
+
+    return true;
+}
+
+Simulation* simulation_create(const Workload* workload, const SimulationConfig* const config,
+                              const char* logFile, const char* traceFile)
+{
+    //START WITH NOTHING CREATED, SO THAT ON AN ERROR simulation_free() ONLY
+    // FREES WHAT HAS BEEN
+    Simulation* sim = calloc(1, sizeof(Simulation));
+    sim->workload = workload;
+    sim->config = *config;
+    sim->printTaskIDs = true;
+    sim->elapsedSecs = 0;
+    sim->info = schedulerInfo_create(config->numCpus);
+    sim->lockStats = lockStats_create();
+    if (config->adaptive)
+    {
+        sim->tuner = tuner_create(&config->tuning, config->bufferSize);
+    }
+
+    sim->log = config->multiProcess ?
+               log_createShared(logFile, config->verbosity, config->sampleEvery) :
+               log_create(logFile, config->verbosity, config->sampleEvery);
+    if (sim->log == NULL || sim->log->file == NULL)
+    {
+        if (sim->log != NULL)
+        {
+            perror("ERROR: The log file could not be opened/created ");
+        }
+        simulation_free(sim);
+        return NULL;
+    }
+
+    if (traceFile != NULL && (sim->trace = trace_create(traceFile)) == NULL)
+    {
+        perror("ERROR: The trace file could not be opened/created ");
+        simulation_free(sim);
+        return NULL;
+    }
+
+    bool created = (sim->buffer = createBuffer(config)) != NULL;
+    if (config->dispatch == DISPATCH_EFT)
+    {
+        sim->cpuBuffers = calloc(config->numCpus, sizeof(Buffer*));
+        for (int i = 0; i < config->numCpus && created; i++)
+        {
+            created = (sim->cpuBuffers[i] = createBuffer(config)) != NULL;
+        }
+    }
+    if (config->multiProcess)
+    {
+        //ONE SLOT FOR THE TASK PROCESS, THEN ONE FOR EACH CPU
+        sim->processInfo = calloc(config->numCpus + 1, sizeof(SchedulerInfo*));
+        for (int i = 0; i <= config->numCpus && created; i++)
+        {
+            created = (sim->processInfo[i] = schedulerInfo_createShared(config->numCpus)) != NULL;
+        }
+    }
+    if (!created || !createCounters(sim))
+    {
+        simulation_free(sim);
+        return NULL;
+    }
+
+    return sim;
+}
+
+void simulation_free(Simulation* sim)
+{
+    if (sim->buffer != NULL)
+    {
+        buffer_free(sim->buffer);
+    }
+    if (sim->cpuBuffers != NULL)
+    {
+        for (int i = 0; i < sim->config.numCpus && sim->cpuBuffers[i] != NULL; i++)
+        {
+            buffer_free(sim->cpuBuffers[i]);
+        }
+        free(sim->cpuBuffers);
+    }
+    if (sim->processInfo != NULL)
+    {
+        for (int i = 0; i <= sim->config.numCpus && sim->processInfo[i] != NULL; i++)
+        {
+            schedulerInfo_free(sim->processInfo[i]);
+        }
+        free(sim->processInfo);
+    }
+    if (sim->outstandingNs != NULL)
+    {
+        //THE COUNTERS ARE THE START OF THEIR BLOCK
+        sem_destroy(sim->released);
+        SharedCounters* counters = (SharedCounters*) sim->outstandingNs;
+        if (sim->config.multiProcess)
+        {
+            sharedMem_free(counters);
+        }
+        else
+        {
+            free(counters);
+        }
+    }
+    if (sim->log != NULL)
+    {
+        log_free(sim->log);
+    }
+    schedulerInfo_free(sim->info);
+    lockStats_free(sim->lockStats);
+    trace_free(sim->trace);
+    tuner_free(sim->tuner);
+    if (sim->stream != NULL)
+    {
+        taskStream_close(sim->stream);
+    }
+    free(sim);
+}
+
+Buffer* simulation_cpuBuffer(Simulation* sim, int cpuID)
+{
+    return sim->cpuBuffers != NULL ? sim->cpuBuffers[cpuID - 1] : sim->buffer;
+}
+
+void simulation_releaseDependents(Simulation* sim, int index, bool shed)
+{
+    const Workload* workload = sim->workload;
+    //TASKS READ ONLINE COME AFTER THE WORKLOAD AND HAVE NO DEPENDENTS
+    if (index >= workload->numTasks)
+    {
+        return;
+    }
+    for (int d = workload->dependentsStart[index]; d < workload->dependentsStart[index + 1]; d++)
+    {
+        const int dependent = workload->dependents[d];
+        if (shed)
+        {
+            atomic_store(&sim->depShed[dependent], true);
+        }
+
+        //ONLY THE LAST DEPENDENCY TO FINISH SEES THE COUNT GO FROM ONE TO ZERO
+        if (atomic_fetch_sub(&sim->depsLeft[dependent], 1) == 1)
+        {
+            int head = atomic_load(sim->releasedHead);
+            do
+            {
+                sim->releasedNext[dependent] = head;
+            }
+            while (!atomic_compare_exchange_weak(sim->releasedHead, &head, dependent));
+            sem_post(sim->released);
+        }
+    }
+}
+
+int simulation_popReleased(Simulation* sim)
+{
+    //A FAILED EXCHANGE RELOADS THE HEAD, A CPU HAVING JUST PUSHED ON TO IT
+    int head = atomic_load(sim->releasedHead);
+    while (head != -1 &&
+           !atomic_compare_exchange_weak(sim->releasedHead, &head, sim->releasedNext[head]))
+    {
+        continue;
+    }
+
+    return head;
+}
+
+double simulation_estimateMakespan(const Workload* const workload,
+                                   const SimulationConfig* const config,
+                                   DispatchMode dispatch)
+{
+    double* freeAt = calloc(config->numCpus, sizeof(double));
+    double makespan = 0;
+
+    for (int i = 0; i < workload->numTasks; i++)
+    {
+        //PICK THE CPU THAT IS FREE FIRST, OR THAT WOULD FINISH THE TASK FIRST
+        const int burst = workload->tasks[i].burst;
+        int chosen = 0;
+        double chosenTime = 0;
+        for (int c = 0; c < config->numCpus; c++)
+        {
+            double time = dispatch == DISPATCH_EFT ?
+                          freeAt[c] + burst / config->speeds[c] : freeAt[c];
+            if (c == 0 || time < chosenTime)
+            {
+                chosen = c;
+                chosenTime = time;
+            }
+        }
+
+        freeAt[chosen] += burst / config->speeds[chosen];
+        if (freeAt[chosen] > makespan)
+        {
+            makespan = freeAt[chosen];
+        }
+    }
+    free(freeAt);
+
+    return makespan;
+}
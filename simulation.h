@@ -0,0 +1,287 @@
+/**
+ * @headerfile simulation.h
+ * @brief Defines the structure of a Simulation, everything that one run of the
+ * scheduler shares between its task and CPU threads, and the functions for
+ * creating and destroying said structure.
+ *
+ * Each Simulation has its own Ready Queue, log, statistics and trace, so any
+ * number of them can run at the same time over one shared Workload.
+ *  In multi-process mode everything the task and CPUs update during the run is
+ * placed in shared memory, see sharedMem.h, so that they can be run as
+ * processes forked from the one that created the Simulation.
+ *
+ * @author Lachlan Mackenzie
+ * @date 18/10/26
+ */
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <semaphore.h>
+#include "buffer.h"
+#include "logFile.h"
+#include "schedulerInfo.h"
+#include "lockStats.h"
+#include "trace.h"
+#include "workload.h"
+#include "taskStream.h"
+#include "tuner.h"
+
+//CONSTANTS
+/**
+ * @brief How tasks are handed to the CPUs.
+ *
+ * @c DISPATCH_FCFS puts every task in one shared Ready Queue and each CPU pulls
+ * the task at its head when it becomes free. @c DISPATCH_EFT gives each CPU its
+ * own Ready Queue and the task thread sends each task to the CPU it estimates
+ * will finish it earliest, given the CPU's speed and the work already sent to it.
+ */
+typedef enum
+{
+    DISPATCH_FCFS,
+    DISPATCH_EFT
+} DispatchMode;
+
+//STRUCTS
+/**
+ * @brief This SimulationConfig struct is used to store the settings of one run
+ * of the scheduler.
+ *
+ * @field bufferSize The capacity of each Ready Queue, or the capacity it starts
+ * with if it is tuned.
+ * @field numCpus The number of simulated CPUs.
+ * @field numWorkerThreads The number of OS threads the simulated CPUs are run
+ * on as coroutines, or 0 to give each simulated CPU its own thread.
+ * @field speeds The speed factor of each CPU, indexed by the CPU's ID minus one.
+ * A CPU with a speed of 2 executes a task in half of its burst length. It is
+ * only read from, so may be shared with other simulations.
+ * @field dispatch How tasks are handed to the CPUs.
+ * @field order The order tasks are removed from each Ready Queue in.
+ * @field admissionControl True if the task thread drops tasks that it estimates
+ * can not meet their deadline, rather than inserting them.
+ * @field multiProcess True if the task thread and each CPU are run as separate
+ * processes rather than as threads.
+ * @field adaptive True if the capacity of each Ready Queue and the number of
+ * tasks inserted at a time are tuned during the run.
+ * @field tuning The range the capacity and number of tasks inserted at a time
+ * are tuned within, only used if @c adaptive is true.
+ * @field verbosity How much is written to the log.
+ * @field sampleEvery Only the arrival, service and completion of one in this
+ * many tasks are written to the log.
+ */
+typedef struct
+{
+    int bufferSize;
+    int numCpus;
+    int numWorkerThreads;
+    const double* speeds;
+    DispatchMode dispatch;
+    BufferOrder order;
+    bool admissionControl;
+    bool multiProcess;
+    bool adaptive;
+    TunerBounds tuning;
+    LogLevel verbosity;
+    int sampleEvery;
+} SimulationConfig;
+
+/**
+ * @brief This Simulation struct is used to store the state of one run of the
+ * scheduler.
+ *
+ * @field workload The tasks to schedule. It is shared with other simulations
+ * and is only ever read from.
+ *
+ * @field config The settings of the run.
+ *
+ * @field buffer This buffer is used as a Ready Queue for the task and CPU
+ * threads to share while avoiding race conditions.
+ *  The task thread is inserting tasks into the buffer while the CPU threads are
+ * removing tasks from the buffer for execution. The buffer uses a mutex lock to
+ * ensure no other thread is accessing the buffer simultaneously, ensuring
+ * mutual exclusion.
+ *  The task thread is blocked if the buffer does not have enough empty spaces
+ * to insert a number of tasks and waits for a signal from the CPU threads when
+ * a task is removed from the buffer.
+ *  The CPU threads are blocked when the buffer is empty as it cannot execute a
+ * task if there are none, these threads are awaiting a signal from the task
+ * thread when a task is inserted into the buffer, ready for execution. Ensuring
+ * progress is made. Once every task has been inserted the task thread closes
+ * the buffer, and the CPU threads exit once it has been drained.
+ *
+ * @field cpuBuffers The Ready Queue of each CPU, indexed by the CPU's ID minus
+ * one, used in place of @c buffer when dispatching by earliest finish time.
+ * Each is shared between the task thread and its one CPU in the same way as
+ * @c buffer. NULL when dispatching FCFS.
+ *
+ * @field log This log file is used by all threads to output their respective
+ * data that needs to be logged.
+ *  The task thread logs the arrival time of each task to file and also when the
+ * thread has inserted all tasks into the buffer, it logs its termination time
+ * and how many tasks were inserted.
+ *  The CPU threads log the service time and completion time of the task to file.
+ * When the CPU threads terminate, they will also log how many task they have
+ * serviced.
+ *
+ * @field info This structure is used to store the statistics of the run.
+ *  It is only used by the CPU threads and then by whoever runs the simulation
+ * once the CPU's have terminated. Each CPU thread updates these statistics
+ * every time a task has been completed.
+ *  In multi-process mode each process updates its own copy, which it hands
+ * back through its slot of @c processInfo when it exits.
+ * @field processInfo The statistics handed back by each process in
+ * multi-process mode, the task process first and then each CPU in order of
+ * ID. Each is in shared memory and is only written by its own process. NULL
+ * unless in multi-process mode.
+ *
+ * @field lockStats This structure collects the lock and wait statistics of
+ * every thread in the run. It is NULL unless the program was built with
+ * LOCK_STATS defined.
+ *
+ * @field trace This trace is used by all threads to export a timeline of the
+ * run. It is NULL, and nothing is exported, unless a trace file was given.
+ *
+ * @field outstandingNs The work that has been inserted into a Ready Queue but
+ * not yet completed, as the nanoseconds a CPU of speed 1 would take to execute
+ * it. The task thread adds to it and the CPU threads subtract from it without
+ * a lock, and the task thread uses it for admission control.
+ *
+ * @field depsLeft The number of tasks each task depends on that have not yet
+ * been completed, indexed by the task's position in the workload. The CPU that
+ * completes a task decrements the count of each of its dependents without a
+ * lock, and whichever brings a count to zero releases that dependent.
+ * @field depShed True for a task if a task it depends on was shed, so it can
+ * never be run and is shed in turn once released.
+ * @field releasedHead The position of the most recently released task not yet
+ * taken by the task thread, or -1. Released tasks form a lock-free stack that
+ * any CPU pushes on to and only the task thread pops from, so a task can not be
+ * popped and pushed again while the task thread is popping it.
+ * @field releasedNext The position of the task below each task in the stack of
+ * released tasks.
+ * @field released Posted once for every task pushed on to the stack of released
+ * tasks, the task thread waits on it when there is nothing left for it to insert.
+ * @field running The position of the task each CPU is running, indexed by the
+ * CPU's ID less one, or -1 if it is not running one. In multi-process mode the
+ * scheduler uses it to release the dependents of a task whose CPU died.
+ * @field idleNs The total time the CPUs have spent waiting on an empty Ready
+ * Queue, in nanoseconds. Each CPU adds to it without a lock, and the task
+ * thread reads it to tune the Ready Queue. Only counted if @c tuner is set.
+ * @field tuner Chooses the capacity of the Ready Queues and the number of tasks
+ * inserted at a time. Only used by the task thread. NULL unless tuning.
+ *
+ * @field stream The input the task thread reads tasks from while running, in
+ * place of the workload, which is then empty. Tasks read this way have no
+ * dependencies. NULL unless reading online, set by whoever creates the
+ * Simulation and closed by simulation_free().
+ * @field printTaskIDs True if each CPU thread prints the ID of every task it
+ * completes to stdout.
+ * @field elapsedSecs How long the run took, set once it has finished.
+ */
+typedef struct
+{
+    const Workload* workload;
+    SimulationConfig config;
+    Buffer* buffer;
+    Buffer** cpuBuffers;
+    Log* log;
+    SchedulerInfo* info;
+    SchedulerInfo** processInfo;
+    LockStats* lockStats;
+    Trace* trace;
+    atomic_llong* outstandingNs;
+    atomic_int* depsLeft;
+    atomic_bool* depShed;
+    atomic_int* releasedHead;
+    int* releasedNext;
+    sem_t* released;
+    atomic_int* running;
+    atomic_llong* idleNs;
+    Tuner* tuner;
+    TaskStream* stream;
+    bool printTaskIDs;
+    double elapsedSecs;
+} Simulation;
+
+//FUNCTION PROTOTYPES
+/**
+ * @brief Creates a Simulation and allocates memory to it on the heap.
+ *
+ * The Ready Queue, or one for each CPU when dispatching by earliest finish time,
+ * log file, statistics and, if a trace file is given, the trace are all created
+ * for this simulation alone. When tuning, each Ready Queue has room for the
+ * largest capacity allowed and starts limited to @c bufferSize. In multi-process mode the Ready Queues, log and
+ * shared counters are created in shared memory. An error is printed to
+ * stderr if the log or trace file can not be opened, or shared memory can not
+ * be created.
+ *
+ * @param workload The tasks to schedule, which must outlive the simulation.
+ * @param config The settings of the run, copied into the simulation.
+ * @param logFile The name of the file to log the run to.
+ * @param traceFile The name of the file to export the timeline to, or NULL.
+ * @return A pointer to the Simulation struct on the heap, or NULL on an error.
+ */
+Simulation* simulation_create(const Workload* workload, const SimulationConfig* const config,
+                              const char* logFile, const char* traceFile);
+
+/**
+ * @brief Deallocates all memory associated with the specified Simulation.
+ *
+ * The shared workload is not freed.
+ *
+ * @param sim The Simulation to deallocate from memory.
+ */
+void simulation_free(Simulation* sim);
+
+/**
+ * @brief Returns the Ready Queue the given CPU removes its tasks from.
+ *
+ * @param sim The Simulation the CPU belongs to.
+ * @param cpuID The ID of the CPU, starting from 1.
+ * @return The CPU's own Ready Queue when dispatching by earliest finish time,
+ * otherwise the shared Ready Queue.
+ */
+Buffer* simulation_cpuBuffer(Simulation* sim, int cpuID);
+
+/**
+ * @brief Counts a task as done for every task that depends on it.
+ *
+ * Each dependent whose last outstanding dependency this was is pushed on to
+ * the stack of released tasks for the task thread to insert. Called by the CPU
+ * that completes the task, or by the task thread when it sheds the task.
+ *
+ * @param sim The Simulation the task belongs to.
+ * @param index The position of the task in the workload.
+ * @param shed True if the task was shed rather than completed, in which case
+ * every dependent is shed too.
+ */
+void simulation_releaseDependents(Simulation* sim, int index, bool shed);
+
+/**
+ * @brief Pops the most recently released task off the stack of released tasks.
+ *
+ * Must only be called by the task thread.
+ *
+ * @param sim The Simulation the task belongs to.
+ * @return The position of the task in the workload, or -1 if none are waiting.
+ */
+int simulation_popReleased(Simulation* sim);
+
+/**
+ * @brief Estimates how long the workload takes to complete with the given
+ * dispatch mode.
+ *
+ * Tasks are handed out in order, all arriving at once and ignoring the capacity
+ * of the Ready Queue and any dependencies between tasks. With FCFS each goes to whichever CPU becomes free first,
+ * with EFT to whichever CPU would finish it first.
+ *
+ * @param workload The tasks to schedule.
+ * @param config The settings of the run, only the CPUs and speeds are used.
+ * @param dispatch The dispatch mode to estimate.
+ * @return The estimated makespan in units of burst length.
+ */
+double simulation_estimateMakespan(const Workload* const workload,
+                                   const SimulationConfig* const config,
+                                   DispatchMode dispatch);
+
+#endif
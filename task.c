@@ -2,23 +2,54 @@
  * See documentation in the header file.
  */
 #include "task.h"
+#include <string.h>
 
-Task* task_create(int id, int burstLength)
+/**
+ * The characters that may separate the fields of a line.
+ */
+static const char* const WHITESPACE = " \t\r\n";
+
+void task_init(Task* task, int id, int burstLength, int deadline, int seq)
 {
-    Task* task = (Task*) malloc(sizeof(Task));
     task->id = id;
     task->burst = burstLength;
-    task->arrivalT = malloc(sizeof(struct tm));
-    task->serviceT = malloc(sizeof(struct tm));
-    task->completionT = malloc(sizeof(struct tm));
-
-    return task;
+    task->deadline = deadline;
+    task->seq = seq;
+    task->deadlineNs = LLONG_MAX;
+    task->arrivalT = 0;
+    task->serviceT = 0;
+    task->completionT = 0;
 }
 
-void task_free(Task* task)
+int task_parseLine(const char* line, int* id, int* burstLength, int* deadline)
 {
-    free(task->arrivalT);
-    free(task->serviceT);
-    free(task->completionT);
-    free(task);
+    long fields[3];
+    int numFields = 0;
+    const char* start = line + strspn(line, WHITESPACE);
+    char* endPtr;
+
+    while (*start != '\0')
+    {
+        //EACH FIELD IS A WHOLE NUMBER ENDED BY WHITESPACE OR THE END OF THE LINE
+        const long value = strtol(start, &endPtr, 10);
+        if (numFields == 3 || endPtr == start || value < INT_MIN || value > INT_MAX ||
+            (*endPtr != '\0' && strchr(WHITESPACE, *endPtr) == NULL))
+        {
+            return -1;
+        }
+        fields[numFields++] = value;
+        start = endPtr + strspn(endPtr, WHITESPACE);
+    }
+    if (numFields == 1 || (numFields > 1 && fields[1] < 0) || (numFields == 3 && fields[2] < 0))
+    {
+        return -1;
+    }
+
+    if (numFields > 0)
+    {
+        *id = (int) fields[0];
+        *burstLength = (int) fields[1];
+        *deadline = numFields == 3 ? (int) fields[2] : 0;
+    }
+    return numFields;
 }
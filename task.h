@@ -11,6 +11,7 @@
 
 #include <stdlib.h>
 #include <time.h>
+#include <limits.h>
 
 //STRUCTS
 /**
@@ -19,12 +20,19 @@
  *
  * This struct is used to contain all the important information regarding a task
  * used in a CPU scheduler. The struct is initialized by the task thread and
- * then inserted into the bounded Ready Queue. The three CPU threads executing
- * cpu() will then remove this struct from the Ready Queue and 'execute' it.
- * After the task has been executed it is then free'd from memory.
+ * then copied by value into the bounded Ready Queue. The three CPU threads
+ * executing cpu() will then copy this struct out of the Ready Queue and
+ * 'execute' it. Times are stored as plain @c time_t values so that a whole task
+ * record is small and self-contained, with no pointers to chase into other heap
+ * blocks.
  *
  * @field id The identifier of the task.
  * @field burst The length of the task execution in seconds.
+ * @field deadline How long after arriving the task must be completed by, in
+ * the same units as @c burst, or 0 if it has no deadline.
+ * @field seq The position of the task in its workload, starting from 0.
+ * @field deadlineNs The time the task must be completed by, from
+ * getTimeNanos(), set when it arrives. LLONG_MAX if it has no deadline.
  * @field arrivalT The time the task arrived in the Ready Queue.
  * @field serviceT The time the task was removed from the buffer.
  * @field completionT The time the task had finished execution.
@@ -33,33 +41,44 @@ typedef struct
 {
     int id;
     int burst;
-    struct tm* arrivalT;
-    struct tm* serviceT;
-    struct tm* completionT;
+    int deadline;
+    int seq;
+    long long deadlineNs;
+    time_t arrivalT;
+    time_t serviceT;
+    time_t completionT;
 } Task;
 
 //FUNCTION PROTOTYPES
 /**
- * @brief Creates a Task struct with given ID and burst length and allocates
- * memory to it on the heap.
+ * @brief Initialises a Task struct with given ID, burst length and deadline.
  *
- * The id and burstLength of the Task are assigned to their respective fields and
- * the arrivalTime, serviceTime, and completionTime are all allocated to memory
- * on the heap.
+ * The id, burstLength, deadline and seq of the Task are assigned to their
+ * respective fields, the absolute deadline is set to none, and the arrivalTime,
+ * serviceTime, and completionTime are all set to zero.
  *
+ * @param task The Task to initialise.
  * @param id The identifier of the task.
  * @param burstLength The length of the task execution in seconds.
- * @return A pointer to the Task struct on the heap.
+ * @param deadline How long after arriving the task must be completed by, or 0.
+ * @param seq The position of the task in its workload.
  */
-Task* task_create(int id, int burstLength);
+void task_init(Task* task, int id, int burstLength, int deadline, int seq);
 
 /**
- * @brief Deallocates all memory associated with the specified Task.
+ * @brief Parses a line in the format: task# cpu_burst_length [deadline]
  *
- * Free's each time value and destroys the mutex lock assigned to the struct.
+ * Each field must be a whole number that fits in an int, separated by
+ * whitespace, with only whitespace after the last. The burst length and
+ * deadline can not be negative.
  *
- * @param task The Task to deallocate from memory.
+ * @param line The line to parse.
+ * @param id Where to store the identifier of the task.
+ * @param burstLength Where to store the length of the task execution.
+ * @param deadline Where to store the deadline, or 0 if there is none.
+ * @return The number of fields read, 0 if the line is blank, or -1 if it is
+ * not in the format.
  */
-void task_free(Task* task);
+int task_parseLine(const char* line, int* id, int* burstLength, int* deadline);
 
 #endif
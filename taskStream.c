@@ -0,0 +1,238 @@
+/**
+ * See documentation in the header file.
+ */
+#include "taskStream.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+
+/**
+ * The number of file descriptors watched by epoll, the input and the signals.
+ */
+#define NUM_WATCHED 2
+
+/**
+ * Parses the complete lines already in the buffer until one holds a task.
+ * Once the input has ended a final line without a newline counts as complete,
+ * but one cut off by a signal is rejected. Returns false if no more tasks can
+ * be parsed without reading.
+ */
+static bool parseLine(TaskStream* stream, Task* task)
+{
+    int id, burst, deadline;
+
+    while (stream->start < stream->end)
+    {
+        char* line = stream->buffer + stream->start;
+        char* newline = memchr(line, '\n', stream->end - stream->start);
+        if (newline == NULL)
+        {
+            if (!stream->ended)
+            {
+                return false;
+            }
+            if (!stream->eof)
+            {
+                stream->lineNum++;
+                if (!stream->skipping)
+                {
+                    fprintf(stderr, "ERROR: Line %d of the input was cut off before its end.\n",
+                            stream->lineNum);
+                    stream->numRejected++;
+                }
+                stream->start = stream->end;
+                return false;
+            }
+            //THERE IS ALWAYS A SPARE BYTE AFTER THE INPUT FOR THE TERMINATOR
+            newline = stream->buffer + stream->end;
+        }
+        *newline = '\0';
+        stream->start = (int) (newline - stream->buffer) + 1;
+        if (stream->start > stream->end)
+        {
+            stream->start = stream->end;
+        }
+        stream->lineNum++;
+        if (stream->skipping)
+        {
+            stream->skipping = false;
+            continue;
+        }
+
+        const int numParsed = task_parseLine(line, &id, &burst, &deadline);
+        if (numParsed == 0)
+        {
+            continue;
+        }
+        if (numParsed < 2)
+        {
+            fprintf(stderr, "ERROR: Line %d of the input is not in the format: "
+                    "task# cpu_burst_length [deadline]\n", stream->lineNum);
+            stream->numRejected++;
+            continue;
+        }
+
+        task_init(task, id, burst, deadline, stream->firstSeq + stream->numTasks);
+        stream->numTasks++;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Reads the next chunk of input after any partial line left in the buffer,
+ * first checking for a signal. Waits for input if there is none and 'wait' is
+ * true. Returns false if nothing was read and the stream has not ended.
+ */
+static bool readChunk(TaskStream* stream, bool wait)
+{
+    //MOVE THE PARTIAL LINE TO THE FRONT, OR SKIP IT IF IT FILLS THE BUFFER
+    memmove(stream->buffer, stream->buffer + stream->start, stream->end - stream->start);
+    stream->end -= stream->start;
+    stream->start = 0;
+    if (stream->end == STREAM_BUFFER_SIZE - 1)
+    {
+        if (!stream->skipping)
+        {
+            fprintf(stderr, "ERROR: Line %d of the input is longer than %d characters.\n",
+                    stream->lineNum + 1, STREAM_BUFFER_SIZE - 2);
+            stream->numRejected++;
+        }
+        stream->skipping = true;
+        stream->end = 0;
+    }
+
+    while (true)
+    {
+        struct signalfd_siginfo info;
+        if (read(stream->signalFd, &info, sizeof(info)) == sizeof(info))
+        {
+            stream->ended = true;
+            return true;
+        }
+
+        const ssize_t numRead = read(stream->fd, stream->buffer + stream->end,
+                                     STREAM_BUFFER_SIZE - 1 - stream->end);
+        if (numRead > 0)
+        {
+            stream->end += (int) numRead;
+            return true;
+        }
+        if (numRead == 0)
+        {
+            stream->ended = true;
+            stream->eof = true;
+            return true;
+        }
+        if (errno == EINTR)
+        {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            perror("ERROR: The input could not be read ");
+            stream->ended = true;
+            return true;
+        }
+        if (!wait)
+        {
+            return false;
+        }
+
+        //SLEEP UNTIL THERE IS INPUT, THE INPUT ENDS, OR A SIGNAL ARRIVES
+        struct epoll_event events[NUM_WATCHED];
+        if (epoll_wait(stream->epollFd, events, NUM_WATCHED, -1) == -1 && errno != EINTR)
+        {
+            perror("ERROR: Could not wait for input ");
+            stream->ended = true;
+            return true;
+        }
+    }
+}
+
+TaskStream* taskStream_open(const char* filename, int firstSeq)
+{
+    TaskStream* stream = malloc(sizeof(TaskStream));
+    stream->ended = false;
+    stream->eof = false;
+    stream->start = 0;
+    stream->end = 0;
+    stream->skipping = false;
+    stream->lineNum = 0;
+    stream->numTasks = 0;
+    stream->numRejected = 0;
+    stream->firstSeq = firstSeq;
+
+    //OPENING A NAMED PIPE WAITS FOR A WRITER, SO IT IS ONLY MADE NON-BLOCKING AFTER
+    stream->fd = strcmp(filename, "-") == 0 ? STDIN_FILENO : open(filename, O_RDONLY);
+    if (stream->fd == -1)
+    {
+        perror("ERROR: The input could not be opened ");
+        free(stream);
+        return NULL;
+    }
+    fcntl(stream->fd, F_SETFL, fcntl(stream->fd, F_GETFL) | O_NONBLOCK);
+
+    //TAKE SIGINT AND SIGTERM THROUGH A FILE DESCRIPTOR INSTEAD OF A HANDLER
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    stream->signalFd = signalfd(-1, &signals, SFD_NONBLOCK);
+
+    struct epoll_event event;
+    stream->epollFd = epoll_create1(0);
+    event.events = EPOLLIN;
+    event.data.fd = stream->signalFd;
+    epoll_ctl(stream->epollFd, EPOLL_CTL_ADD, stream->signalFd, &event);
+    event.data.fd = stream->fd;
+    //A REGULAR FILE CAN NOT BE WATCHED, BUT IS ALWAYS READY SO IS NEVER WAITED ON
+    if (epoll_ctl(stream->epollFd, EPOLL_CTL_ADD, stream->fd, &event) == -1 && errno != EPERM)
+    {
+        perror("ERROR: The input can not be watched for new tasks ");
+        taskStream_close(stream);
+        return NULL;
+    }
+
+    return stream;
+}
+
+bool taskStream_next(TaskStream* stream, Task* task, bool wait)
+{
+    while (!parseLine(stream, task))
+    {
+        if (stream->ended || !readChunk(stream, wait))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool taskStream_hasEnded(const TaskStream* const stream)
+{
+    return stream->ended && stream->start == stream->end;
+}
+
+void taskStream_close(TaskStream* stream)
+{
+    if (stream->fd == STDIN_FILENO)
+    {
+        fcntl(stream->fd, F_SETFL, fcntl(stream->fd, F_GETFL) & ~O_NONBLOCK);
+    }
+    else
+    {
+        close(stream->fd);
+    }
+    close(stream->signalFd);
+    close(stream->epollFd);
+    free(stream);
+}
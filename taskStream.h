@@ -0,0 +1,119 @@
+/**
+ * @headerfile taskStream.h
+ * @brief Defines a TaskStream, used to read tasks from stdin or a named pipe
+ * while the scheduler is running, rather than from a task file up front.
+ *
+ * The input is read without blocking, in chunks as large as the buffer, and
+ * every complete line in a chunk is parsed straight out of memory, so a burst
+ * of thousands of tasks takes a handful of reads rather than one per task.
+ * When there is nothing to read the stream waits with epoll on both the input
+ * and a signalfd, so it wakes for new input, the end of the input, or SIGINT or
+ * SIGTERM, whichever comes first. Either ends the stream, after which the tasks
+ * already read can be drained.
+ *
+ * @author Lachlan Mackenzie
+ * @date 18/10/26
+ */
+#ifndef TASKSTREAM_H
+#define TASKSTREAM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "task.h"
+
+//CONSTANTS
+/**
+ * The size of each chunk read from the input in bytes. It also bounds the
+ * length of a line, longer lines are skipped.
+ */
+#define STREAM_BUFFER_SIZE 65536
+
+//STRUCTS
+/**
+ * @brief This TaskStream struct is used to store the state of reading tasks
+ * from an input that may not have ended yet.
+ *
+ * @field fd The input, in non-blocking mode.
+ * @field epollFd The epoll instance watching the input and the signals.
+ * @field signalFd Becomes readable once SIGINT or SIGTERM has been received.
+ * @field ended True once the input has ended or a signal has been received.
+ * @field eof True if the stream ended because the input did, rather than on a
+ * signal or an error, so a final line without a newline is complete.
+ * @field start The index of the first byte in @c buffer not yet parsed.
+ * @field end The index after the last byte read into @c buffer.
+ * @field skipping True while skipping the rest of a line that was too long.
+ * @field lineNum The number of lines read so far.
+ * @field numTasks The number of tasks read so far.
+ * @field numRejected The number of lines that were not in the correct format.
+ * @field firstSeq The position given to the first task read, those after it are
+ * numbered on from it.
+ * @field buffer The bytes read but not yet parsed.
+ */
+typedef struct
+{
+    int fd;
+    int epollFd;
+    int signalFd;
+    bool ended;
+    bool eof;
+    int start;
+    int end;
+    bool skipping;
+    int lineNum;
+    int numTasks;
+    int numRejected;
+    int firstSeq;
+    char buffer[STREAM_BUFFER_SIZE];
+} TaskStream;
+
+//FUNCTION PROTOTYPES
+/**
+ * @brief Opens a TaskStream and allocates memory to it on the heap.
+ *
+ * A named pipe is opened for reading, which waits until something opens it for
+ * writing. SIGINT and SIGTERM are then blocked, so that they are only received
+ * through the stream. This must be called before any other thread is created,
+ * so that every thread inherits the blocked signals. An error is printed to
+ * stderr if the input can not be opened or watched.
+ *
+ * @param filename The named pipe or file to read from, or "-" for stdin.
+ * @param firstSeq The position to give the first task read.
+ * @return A pointer to the TaskStream struct on the heap, or NULL on an error.
+ */
+TaskStream* taskStream_open(const char* filename, int firstSeq);
+
+/**
+ * @brief Reads the next task from the stream.
+ *
+ * Each line is in the format: task# cpu_burst_length [deadline]
+ * Lines that are not are reported to stderr and skipped, as is a final line
+ * cut off by a signal before its newline arrived.
+ *
+ * @param stream The stream to read from.
+ * @param task Where to store the task.
+ * @param wait True to wait until a task arrives or the stream ends, false to
+ * only take a task that has already arrived.
+ * @return True if a task was read, false if there was none to take or the
+ * stream has ended.
+ */
+bool taskStream_next(TaskStream* stream, Task* task, bool wait);
+
+/**
+ * @brief Returns true once the input has ended or a signal has been received,
+ * and every task read has been taken.
+ *
+ * @param stream The stream to check.
+ * @return True if no more tasks will be read.
+ */
+bool taskStream_hasEnded(const TaskStream* const stream);
+
+/**
+ * @brief Closes the input and deallocates all memory associated with the
+ * specified TaskStream.
+ *
+ * @param stream The TaskStream to deallocate from memory.
+ */
+void taskStream_close(TaskStream* stream);
+
+#endif
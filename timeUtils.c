@@ -3,28 +3,31 @@
  */
 #include "timeUtils.h"
 
-struct tm* getCurrTime()
+time_t getCurrTime()
 {
-    time_t rawTime;
-    time(&rawTime);
-    return localtime(&rawTime);
+    return time(NULL);
 }
 
-int timeDiffSecs(const struct tm* const before, const struct tm* const after)
+long long getTimeNanos()
 {
-    return (after->tm_hour * 3600 + after->tm_min * 60 + after->tm_sec) -
-           (before->tm_hour * 3600 + before->tm_min * 60 + before->tm_sec);
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long) now.tv_sec * 1000000000LL + now.tv_nsec;
 }
 
-void logArrivalTime(FILE* outFile, int id, int burstLength, const struct tm* const arrivalTime)
+int timeDiffSecs(time_t before, time_t after)
+{
+    return (int) difftime(after, before);
+}
+
+void logArrivalTime(FILE* outFile, int id, int burstLength, time_t arrivalTime)
 {
     fprintf(outFile, "Task #%d: %d\n", id, burstLength);
     logTime(outFile, "Arrival", arrivalTime);
     fprintf(outFile, "\n");
 }
 
-void logServiceTime(FILE* outFile, int cpuID, int taskID,
-                    const struct tm* const arrival, const struct tm* const service)
+void logServiceTime(FILE* outFile, int cpuID, int taskID, time_t arrival, time_t service)
 {
     fprintf(outFile, "Statistics for CPU-%d\n", cpuID);
     fprintf(outFile, "Task #%d\n", taskID);
@@ -33,8 +36,7 @@ void logServiceTime(FILE* outFile, int cpuID, int taskID,
     fprintf(outFile, "\n");
 }
 
-void logCompletionTime(FILE* outFile, int cpuID, int taskID,
-                       const struct tm* const arrival, const struct tm* const completion)
+void logCompletionTime(FILE* outFile, int cpuID, int taskID, time_t arrival, time_t completion)
 {
     fprintf(outFile, "Statistics for CPU-%d\n", cpuID);
     fprintf(outFile, "Task #%d\n", taskID);
@@ -43,7 +45,10 @@ void logCompletionTime(FILE* outFile, int cpuID, int taskID,
     fprintf(outFile, "\n");
 }
 
-void logTime(FILE* outFile, char* timeType, const struct tm* const time)
+void logTime(FILE* outFile, char* timeType, time_t time)
 {
-    fprintf(outFile, "%s time: %d:%d:%d\n", timeType, time->tm_hour, time->tm_min, time->tm_sec);
+    //localtime_r IS USED AS localtime SHARES ONE STATIC STRUCT BETWEEN THREADS
+    struct tm local;
+    localtime_r(&time, &local);
+    fprintf(outFile, "%s time: %d:%d:%d\n", timeType, local.tm_hour, local.tm_min, local.tm_sec);
 }
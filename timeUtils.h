@@ -15,9 +15,16 @@
 /**
  * @brief Retrieves the current time of execution.
  *
- * @return The current time of type, @c tm*.
+ * @return The current time of type, @c time_t.
  */
-struct tm* getCurrTime();
+time_t getCurrTime();
+
+/**
+ * @brief Retrieves a monotonic timestamp for measuring short durations.
+ *
+ * @return The number of nanoseconds since an arbitrary fixed point.
+ */
+long long getTimeNanos();
 
 /**
  * @brief Calculates the number of seconds between two different times.
@@ -26,7 +33,7 @@ struct tm* getCurrTime();
  * @param after The time used to calculate the difference to.
  * @return The number of seconds between the times given.
  */
-int timeDiffSecs(const struct tm* const before, const struct tm* const after);
+int timeDiffSecs(time_t before, time_t after);
 
 /**
  * @brief Logs the arrival time of a specific task to the given file.
@@ -36,7 +43,7 @@ int timeDiffSecs(const struct tm* const before, const struct tm* const after);
  * @param burstLength The CPU burst time of the task.
  * @param arrivalTime The time the task arrived in the Ready Queue.
  */
-void logArrivalTime(FILE* outFile, int id, int burstLength, const struct tm* const arrivalTime);
+void logArrivalTime(FILE* outFile, int id, int burstLength, time_t arrivalTime);
 
 /**
  * @brief Logs the service time of a specific task to the given file.
@@ -47,8 +54,7 @@ void logArrivalTime(FILE* outFile, int id, int burstLength, const struct tm* con
  * @param arrival The time the task arrived in the Ready Queue.
  * @param service The time the task was removed by the CPU.
  */
-void logServiceTime(FILE* outFile, int cpuID, int taskID,
-                    const struct tm* const arrival, const struct tm* const service);
+void logServiceTime(FILE* outFile, int cpuID, int taskID, time_t arrival, time_t service);
 
 /**
  * @brief Logs the completion time of a specific task to the given file.
@@ -59,15 +65,15 @@ void logServiceTime(FILE* outFile, int cpuID, int taskID,
  * @param arrival The time the task arrived in the Ready Queue.
  * @param service The time the task had finished execution by the CPU.
  */
-void logCompletionTime(FILE* outFile, int cpuID, int taskID,
-                       const struct tm* const arrival, const struct tm* const completion);
+void logCompletionTime(FILE* outFile, int cpuID, int taskID, time_t arrival, time_t completion);
 
 /**
- * @brief Logs a @c tm* struct in the format of hh:mm:ss to a specified file.
+ * @brief Logs a @c time_t in the local time format of hh:mm:ss to a specified
+ * file.
  *
  * @param outFile The file to write the given information to.
  * @param timeType The string to be logged alongside the time.
  * @param time The time to be logged.
  */
-void logTime(FILE* outFile, char* timeType, const struct tm* const time);
+void logTime(FILE* outFile, char* timeType, time_t time);
 #endif
@@ -0,0 +1,117 @@
+/**
+ * See documentation in the header file.
+ */
+#include "trace.h"
+#include <stdlib.h>
+#include "timeUtils.h"
+
+/**
+ * Starts a new event in the trace, the caller must hold the trace's mutex.
+ */
+static void beginEvent(Trace* trace)
+{
+    fprintf(trace->file, trace->firstEvent ? "\n" : ",\n");
+    trace->firstEvent = false;
+}
+
+/**
+ * Converts a getTimeNanos() timestamp to microseconds since the trace started.
+ */
+static double toTraceMicros(const Trace* const trace, long long timeNs)
+{
+    return (timeNs - trace->startNs) / 1000.0;
+}
+
+Trace* trace_create(const char* filename)
+{
+    FILE* file = fopen(filename, "w");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+
+    Trace* trace = malloc(sizeof(Trace));
+    trace->file = file;
+    trace->startNs = getTimeNanos();
+    trace->firstEvent = true;
+    pthread_mutex_init(&trace->mutex, NULL);
+    fprintf(trace->file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    return trace;
+}
+
+void trace_free(Trace* trace)
+{
+    if (trace == NULL)
+    {
+        return;
+    }
+
+    fprintf(trace->file, "\n]}\n");
+    fclose(trace->file);
+    pthread_mutex_destroy(&trace->mutex);
+    free(trace);
+}
+
+void trace_nameTrack(Trace* trace, int track, const char* name)
+{
+    if (trace == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&trace->mutex);
+    beginEvent(trace);
+    fprintf(trace->file, "{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\","
+            "\"args\":{\"name\":\"%s\"}}", track, name);
+    beginEvent(trace);
+    fprintf(trace->file, "{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_sort_index\","
+            "\"args\":{\"sort_index\":%d}}", track, track);
+    pthread_mutex_unlock(&trace->mutex);
+}
+
+void trace_span(Trace* trace, int track, const char* name, int taskID,
+                long long startNs, long long endNs)
+{
+    if (trace == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&trace->mutex);
+    beginEvent(trace);
+    fprintf(trace->file, "{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"name\":\"%s\","
+            "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"task\":%d}}",
+            track, name, toTraceMicros(trace, startNs), (endNs - startNs) / 1000.0, taskID);
+    pthread_mutex_unlock(&trace->mutex);
+}
+
+void trace_instant(Trace* trace, int track, const char* name, int taskID, long long timeNs)
+{
+    if (trace == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&trace->mutex);
+    beginEvent(trace);
+    fprintf(trace->file, "{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"name\":\"%s\","
+            "\"ts\":%.3f,\"args\":{\"task\":%d}}",
+            track, name, toTraceMicros(trace, timeNs), taskID);
+    pthread_mutex_unlock(&trace->mutex);
+}
+
+void trace_counter(Trace* trace, const char* name, int value, long long timeNs)
+{
+    if (trace == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&trace->mutex);
+    beginEvent(trace);
+    fprintf(trace->file, "{\"ph\":\"C\",\"pid\":1,\"name\":\"%s\",\"ts\":%.3f,"
+            "\"args\":{\"tasks\":%d}}",
+            name, toTraceMicros(trace, timeNs), value);
+    pthread_mutex_unlock(&trace->mutex);
+}
@@ -0,0 +1,112 @@
+/**
+ * @headerfile trace.h
+ * @brief Defines the structure of a Trace, used to export a timeline of the
+ * simulation in the Chrome Trace Event JSON format.
+ *
+ * The exported file can be opened in chrome://tracing or ui.perfetto.dev. Each
+ * thread of the scheduler is given its own track, identified by a track ID, and
+ * the occupancy of the Ready Queue is exported as a counter track.
+ *  Every function does nothing when given a NULL Trace, so callers can pass the
+ * trace through unconditionally when tracing has not been requested.
+ *
+ * @author Lachlan Mackenzie
+ * @date 18/10/26
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+//CONSTANTS
+/**
+ * The track ID of the task thread. The CPU threads use their CPU ID.
+ */
+#define TRACE_PRODUCER_TRACK 0
+
+//STRUCTS
+/**
+ * @brief This Trace struct is used to store the output file of the trace and
+ * the mutex lock used to write to it safely between threads.
+ *
+ * @field file The JSON file the trace events are written to.
+ * @field mutex The lock that ensures mutual exclusion on threads writing events.
+ * @field startNs The time the trace was created, all timestamps are relative
+ * to it.
+ * @field firstEvent True until an event has been written, used to place the
+ * commas between events.
+ */
+typedef struct
+{
+    FILE* file;
+    pthread_mutex_t mutex;
+    long long startNs;
+    bool firstEvent;
+} Trace;
+
+//FUNCTION PROTOTYPES
+/**
+ * @brief Creates a Trace and allocates memory to it on the heap.
+ *
+ * The file with the given filename is opened and the start of the JSON document
+ * is written to it.
+ *
+ * @param filename The name of the file to write the trace to.
+ * @return A pointer to the Trace struct on the heap, or NULL if the file could
+ * not be opened.
+ */
+Trace* trace_create(const char* filename);
+
+/**
+ * @brief Finishes the JSON document and deallocates all memory associated with
+ * the specified Trace.
+ *
+ * @param trace The Trace to close and deallocate from memory.
+ */
+void trace_free(Trace* trace);
+
+/**
+ * @brief Names the track with the given ID in the trace viewer.
+ *
+ * @param trace The trace to write to.
+ * @param track The ID of the track.
+ * @param name The name to show for the track.
+ */
+void trace_nameTrack(Trace* trace, int track, const char* name);
+
+/**
+ * @brief Writes a span that covers the time between two timestamps.
+ *
+ * @param trace The trace to write to.
+ * @param track The ID of the track the span is shown on.
+ * @param name The name of the span.
+ * @param taskID The ID of the task the span belongs to, or -1 for none.
+ * @param startNs When the span started, from getTimeNanos().
+ * @param endNs When the span ended, from getTimeNanos().
+ */
+void trace_span(Trace* trace, int track, const char* name, int taskID,
+                long long startNs, long long endNs);
+
+/**
+ * @brief Writes an event that happened at a single point in time.
+ *
+ * @param trace The trace to write to.
+ * @param track The ID of the track the event is shown on.
+ * @param name The name of the event.
+ * @param taskID The ID of the task the event belongs to, or -1 for none.
+ * @param timeNs When the event happened, from getTimeNanos().
+ */
+void trace_instant(Trace* trace, int track, const char* name, int taskID, long long timeNs);
+
+/**
+ * @brief Writes a new value of a counter track.
+ *
+ * @param trace The trace to write to.
+ * @param name The name of the counter.
+ * @param value The value of the counter from now on.
+ * @param timeNs When the counter changed, from getTimeNanos().
+ */
+void trace_counter(Trace* trace, const char* name, int value, long long timeNs);
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * See documentation in the header file.
+ */
+#include "tuner.h"
+
+/**
+ * Returns @p value moved into the range from @p min to @p max.
+ */
+static int clamp(int value, int min, int max)
+{
+    return value < min ? min : (value > max ? max : value);
+}
+
+Tuner* tuner_create(const TunerBounds* const bounds, int capacity)
+{
+    Tuner* tuner = malloc(sizeof(Tuner));
+    tuner->bounds = *bounds;
+    tuner->capacity = clamp(capacity, bounds->minCapacity, bounds->maxCapacity);
+    tuner->batch = clamp(2, bounds->minBatch, bounds->maxBatch);
+    tuner->batch = tuner->batch < tuner->capacity ? tuner->batch : tuner->capacity;
+    tuner->epochStart = 0;
+    tuner->epochIdleNs = 0;
+    tuner->stallNs = 0;
+    tuner->occupiedSum = 0;
+    tuner->numSamples = 0;
+    tuner->fullEpochs = 0;
+    tuner->numEpochs = 0;
+    tuner->numChanges = 0;
+
+    return tuner;
+}
+
+void tuner_record(Tuner* tuner, int occupied, long long stallNs)
+{
+    tuner->occupiedSum += occupied;
+    tuner->numSamples++;
+    tuner->stallNs += stallNs;
+}
+
+bool tuner_epochEnded(const Tuner* const tuner, long long now)
+{
+    return now - tuner->epochStart >= TUNER_EPOCH_NS;
+}
+
+bool tuner_decide(Tuner* tuner, long long now, long long idleNs, int numCpus, FILE* log)
+{
+    const TunerBounds* bounds = &tuner->bounds;
+    const int oldCapacity = tuner->capacity, oldBatch = tuner->batch;
+
+    //THE FIRST EPOCH STARTS AT THE FIRST INSERTION, WITH NOTHING MEASURED BEFORE IT
+    if (tuner->epochStart == 0)
+    {
+        tuner->epochStart = now;
+        tuner->epochIdleNs = idleNs;
+        tuner->stallNs = 0;
+        tuner->occupiedSum = 0;
+        tuner->numSamples = 0;
+        return false;
+    }
+
+    const double epochNs = (double) (now - tuner->epochStart);
+    const double stalled = tuner->stallNs / epochNs;
+    const double idle = (idleNs - tuner->epochIdleNs) / (epochNs * numCpus);
+    const double occupied = tuner->numSamples > 0 ?
+                            (double) tuner->occupiedSum / tuner->numSamples : 0.0;
+
+    //CAPACITY: GROW FAST WHILE THE CPUS STARVE, SHRINK SLOWLY WHILE THEY ARE SATURATED
+    if (idle > TUNER_HIGH && stalled > TUNER_HIGH)
+    {
+        tuner->capacity *= 2;
+        tuner->fullEpochs = 0;
+    }
+    else if (idle < TUNER_LOW && occupied > TUNER_FULL * oldCapacity)
+    {
+        if (++tuner->fullEpochs >= TUNER_SHRINK_EPOCHS)
+        {
+            tuner->capacity--;
+            tuner->fullEpochs = 0;
+        }
+    }
+    else
+    {
+        tuner->fullEpochs = 0;
+    }
+    tuner->capacity = clamp(tuner->capacity, bounds->minCapacity, bounds->maxCapacity);
+
+    //BATCH SIZE: SMALLER IF WAITING FOR ROOM FOR IT, LARGER IF THE TASK THREAD LAGS
+    if (stalled > TUNER_HIGH && occupied < TUNER_EMPTY * oldCapacity)
+    {
+        tuner->batch--;
+    }
+    else if (stalled < TUNER_LOW && idle > TUNER_HIGH)
+    {
+        tuner->batch++;
+    }
+    tuner->batch = clamp(tuner->batch, bounds->minBatch, bounds->maxBatch);
+    tuner->batch = tuner->batch < tuner->capacity ? tuner->batch : tuner->capacity;
+
+    const bool changed = tuner->capacity != oldCapacity || tuner->batch != oldBatch;
+    tuner->numEpochs++;
+    tuner->numChanges += changed;
+    if (log != NULL)
+    {
+        fprintf(log, "Tuner: task thread stalled %.1f%%, CPUs idle %.1f%%, queue %.1f/%d full on average\n",
+                100.0 * stalled, 100.0 * idle, occupied, oldCapacity);
+        if (changed)
+        {
+            fprintf(log, "Capacity %d -> %d, batch size %d -> %d\n\n",
+                    oldCapacity, tuner->capacity, oldBatch, tuner->batch);
+        }
+        else
+        {
+            fprintf(log, "Kept capacity %d and batch size %d\n\n", tuner->capacity, tuner->batch);
+        }
+    }
+
+    //START THE NEXT EPOCH
+    tuner->epochStart = now;
+    tuner->epochIdleNs = idleNs;
+    tuner->stallNs = 0;
+    tuner->occupiedSum = 0;
+    tuner->numSamples = 0;
+
+    return changed;
+}
+
+void tuner_free(Tuner* tuner)
+{
+    free(tuner);
+}
@@ -0,0 +1,184 @@
+/**
+ * @headerfile tuner.h
+ * @brief Defines a Tuner, which adjusts the capacity of the Ready Queue and the
+ * number of tasks the task thread inserts at a time while the scheduler runs.
+ *
+ * The task thread feeds the Tuner the time it spends stalled on a full queue
+ * and how full the queue is each time it inserts. The CPUs add the time they
+ * spend idle on an empty queue to a shared counter. At the end of every epoch
+ * the Tuner looks at the three together:
+ *  - CPUs idle while the task thread stalls means the queue is too small to
+ *    cover the gaps between insertions, so its capacity is doubled.
+ *  - CPUs never idle while the queue stays nearly full means the CPUs are the
+ *    bottleneck and the extra slots only add waiting time, so after a few such
+ *    epochs in a row the capacity is lowered by one.
+ *  - The task thread stalling while the queue is mostly empty means it is
+ *    waiting for room for a whole batch, so the batch size is lowered by one.
+ *  - CPUs idle while the task thread never stalls means the task thread can
+ *    not keep up, so the batch size is raised by one to take the lock less
+ *    often.
+ * Growing quickly and shrinking slowly keeps the CPUs fed first and only then
+ * trims the queue. Both values always stay within the bounds given by the user,
+ * and the batch size never exceeds the capacity.
+ *
+ * @author Lachlan Mackenzie
+ * @date 18/10/26
+ */
+#ifndef TUNER_H
+#define TUNER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+//CONSTANTS
+/**
+ * How long the Tuner measures for before each decision, in nanoseconds.
+ */
+#define TUNER_EPOCH_NS 250000000LL
+
+/**
+ * The fraction of an epoch above which the task thread has stalled, or the
+ * CPUs have been idle, enough to act on.
+ */
+#define TUNER_HIGH 0.05
+
+/**
+ * The fraction of an epoch below which the task thread, or the CPUs, count as
+ * never having waited.
+ */
+#define TUNER_LOW 0.01
+
+/**
+ * How full the queue must be on average, as a fraction of its capacity, for
+ * it to count as nearly full.
+ */
+#define TUNER_FULL 0.75
+
+/**
+ * How full the queue must be below on average, as a fraction of its capacity,
+ * for it to count as mostly empty.
+ */
+#define TUNER_EMPTY 0.5
+
+/**
+ * The number of epochs in a row the queue must be nearly full, with the CPUs
+ * never idle, before its capacity is lowered.
+ */
+#define TUNER_SHRINK_EPOCHS 3
+
+//STRUCTS
+/**
+ * @brief This TunerBounds struct is used to store the range the Tuner may
+ * adjust each value within, inclusive.
+ *
+ * @field minCapacity The smallest capacity of the Ready Queue.
+ * @field maxCapacity The largest capacity of the Ready Queue.
+ * @field minBatch The fewest tasks to insert at a time.
+ * @field maxBatch The most tasks to insert at a time.
+ */
+typedef struct
+{
+    int minCapacity;
+    int maxCapacity;
+    int minBatch;
+    int maxBatch;
+} TunerBounds;
+
+/**
+ * @brief This Tuner struct is used to store the current settings chosen by the
+ * Tuner and what it has measured during the current epoch. It is only used by
+ * the task thread.
+ *
+ * @field bounds The range each setting is kept within.
+ * @field capacity The capacity the Ready Queue should have.
+ * @field batch The number of tasks to insert at a time.
+ * @field epochStart When the current epoch started, from getTimeNanos(), or 0
+ * if no task has been inserted yet.
+ * @field epochIdleNs The total time the CPUs had been idle when the current
+ * epoch started.
+ * @field stallNs The time the task thread has stalled on a full queue during
+ * the current epoch.
+ * @field occupiedSum The sum of how many tasks were in the queue at each
+ * insertion during the current epoch.
+ * @field numSamples The number of insertions during the current epoch.
+ * @field fullEpochs The number of epochs in a row the queue was nearly full
+ * with the CPUs never idle.
+ * @field numEpochs The number of epochs that have ended.
+ * @field numChanges The number of epochs that ended with a setting changed.
+ */
+typedef struct
+{
+    TunerBounds bounds;
+    int capacity;
+    int batch;
+    long long epochStart;
+    long long epochIdleNs;
+    long long stallNs;
+    long long occupiedSum;
+    int numSamples;
+    int fullEpochs;
+    int numEpochs;
+    int numChanges;
+} Tuner;
+
+//FUNCTION PROTOTYPES
+/**
+ * @brief Creates a Tuner and allocates memory to it on the heap.
+ *
+ * The capacity starts at @p capacity, and the batch size at 2 as the task
+ * thread uses without a Tuner, each moved into its bounds.
+ *
+ * @param bounds The range each setting is kept within.
+ * @param capacity The capacity to start the Ready Queue with.
+ * @return A pointer to the Tuner struct on the heap.
+ */
+Tuner* tuner_create(const TunerBounds* const bounds, int capacity);
+
+/**
+ * @brief Records one insertion by the task thread.
+ *
+ * @param tuner The Tuner to record in.
+ * @param occupied How many tasks were in the queue when the task thread came to
+ * insert, before waiting for room.
+ * @param stallNs How long the task thread waited for room to insert.
+ */
+void tuner_record(Tuner* tuner, int occupied, long long stallNs);
+
+/**
+ * @brief Returns true once the current epoch has run its length.
+ *
+ * This only checks the time, so the caller can avoid taking the log's lock
+ * for tuner_decide() until there is a decision to make.
+ *
+ * @param tuner The Tuner to check.
+ * @param now The current time, from getTimeNanos().
+ * @return True if the epoch has ended and tuner_decide() should be called.
+ */
+bool tuner_epochEnded(const Tuner* const tuner, long long now);
+
+/**
+ * @brief Ends the current epoch, adjusting the settings from what was measured
+ * during it and starting the next.
+ *
+ * What was measured is written to @p log along with the settings chosen,
+ * whether or not they changed. The caller must hold the log's lock if it can
+ * be written to by another thread.
+ *
+ * @param tuner The Tuner to update.
+ * @param now The current time, from getTimeNanos().
+ * @param idleNs The total time every CPU has been idle on an empty queue.
+ * @param numCpus The number of CPUs.
+ * @param log The file to write the epoch to, or NULL to not write it.
+ * @return True if the capacity or batch size was changed.
+ */
+bool tuner_decide(Tuner* tuner, long long now, long long idleNs, int numCpus, FILE* log);
+
+/**
+ * @brief Deallocates the specified Tuner.
+ *
+ * @param tuner The Tuner to deallocate from memory, or NULL.
+ */
+void tuner_free(Tuner* tuner);
+
+#endif
@@ -0,0 +1,291 @@
+/**
+ * See documentation in the header file.
+ */
+#include "workload.h"
+
+/**
+ * A task ID and the position of the task in the file, sorted by ID to look up
+ * the task a dependency refers to.
+ */
+typedef struct
+{
+    int id;
+    int index;
+} TaskIndex;
+
+/**
+ * Orders TaskIndex entries by task ID, then by position.
+ */
+static int compareTaskIndex(const void* a, const void* b)
+{
+    const TaskIndex* x = (const TaskIndex*) a;
+    const TaskIndex* y = (const TaskIndex*) b;
+    if (x->id != y->id)
+    {
+        return x->id < y->id ? -1 : 1;
+    }
+    return x->index < y->index ? -1 : x->index > y->index;
+}
+
+/**
+ * Turns the dependency list of every task, given as task IDs, into the list of
+ * dependents of every task and works out the critical path. Prints an error
+ * and returns false if a dependency can not be found or they form a cycle.
+ *
+ * @param workload The workload, with every task read in.
+ * @param depOwners The position of the task each dependency belongs to.
+ * @param depIDs The ID of the task each dependency refers to.
+ * @param numEdges The number of dependencies.
+ */
+static bool linkDependencies(Workload* workload, const int* depOwners, const int* depIDs,
+                             int numEdges)
+{
+    const int numTasks = workload->numTasks;
+    bool valid = true;
+    workload->numDeps = calloc(numTasks, sizeof(int));
+    workload->dependentsStart = calloc(numTasks + 1, sizeof(int));
+    workload->dependents = malloc(sizeof(int) * (numEdges > 0 ? numEdges : 1));
+    workload->hasDeps = numEdges > 0;
+    workload->criticalPath = 0;
+    workload->totalBurst = 0;
+    for (int i = 0; i < numTasks; i++)
+    {
+        workload->totalBurst += workload->tasks[i].burst;
+    }
+
+    //FIND THE POSITION OF THE TASK EACH DEPENDENCY REFERS TO
+    TaskIndex* byID = malloc(sizeof(TaskIndex) * (numTasks > 0 ? numTasks : 1));
+    int* depIndices = malloc(sizeof(int) * (numEdges > 0 ? numEdges : 1));
+    for (int i = 0; i < numTasks; i++)
+    {
+        byID[i].id = workload->tasks[i].id;
+        byID[i].index = i;
+    }
+    qsort(byID, numTasks, sizeof(TaskIndex), compareTaskIndex);
+    for (int e = 0; e < numEdges && valid; e++)
+    {
+        //THE KEY SORTS BEFORE EVERY TASK WITH THE ID, SO SEARCH FOR THE FIRST ONE
+        const TaskIndex key = {depIDs[e], -1};
+        int lo = 0, hi = numTasks;
+        while (lo < hi)
+        {
+            const int mid = (lo + hi) / 2;
+            if (compareTaskIndex(&byID[mid], &key) < 0)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        if (lo == numTasks || byID[lo].id != depIDs[e])
+        {
+            fprintf(stderr, "ERROR: Task %d depends on task %d, which is not in the task file.\n",
+                    workload->tasks[depOwners[e]].id, depIDs[e]);
+            valid = false;
+        }
+        else if (lo + 1 < numTasks && byID[lo + 1].id == depIDs[e])
+        {
+            fprintf(stderr, "ERROR: Task %d depends on task %d, which is in the task file "
+                    "more than once.\n", workload->tasks[depOwners[e]].id, depIDs[e]);
+            valid = false;
+        }
+        else
+        {
+            depIndices[e] = byID[lo].index;
+        }
+    }
+    free(byID);
+
+    if (valid)
+    {
+        //COUNT THE DEPENDENCIES AND DEPENDENTS OF EACH TASK, THEN FILL IN THE
+        // DEPENDENTS OF EACH TASK AFTER THOSE OF THE TASKS BEFORE IT
+        for (int e = 0; e < numEdges; e++)
+        {
+            workload->numDeps[depOwners[e]]++;
+            workload->dependentsStart[depIndices[e] + 1]++;
+        }
+        for (int i = 0; i < numTasks; i++)
+        {
+            workload->dependentsStart[i + 1] += workload->dependentsStart[i];
+        }
+        int* next = malloc(sizeof(int) * (numTasks > 0 ? numTasks : 1));
+        memcpy(next, workload->dependentsStart, sizeof(int) * numTasks);
+        for (int e = 0; e < numEdges; e++)
+        {
+            workload->dependents[next[depIndices[e]]++] = depOwners[e];
+        }
+        free(next);
+
+        //VISIT THE TASKS IN DEPENDENCY ORDER, FINDING THE LONGEST CHAIN THAT ENDS
+        // WITH EACH. ANY TASK NEVER VISITED IS ON A CYCLE
+        int* depsLeft = malloc(sizeof(int) * (numTasks > 0 ? numTasks : 1));
+        int* ready = malloc(sizeof(int) * (numTasks > 0 ? numTasks : 1));
+        long long* startAt = calloc(numTasks > 0 ? numTasks : 1, sizeof(long long));
+        int numReady = 0, numVisited = 0;
+        memcpy(depsLeft, workload->numDeps, sizeof(int) * numTasks);
+        for (int i = 0; i < numTasks; i++)
+        {
+            if (depsLeft[i] == 0)
+            {
+                ready[numReady++] = i;
+            }
+        }
+        while (numVisited < numReady)
+        {
+            const int t = ready[numVisited++];
+            const long long finish = startAt[t] + workload->tasks[t].burst;
+            if (finish > workload->criticalPath)
+            {
+                workload->criticalPath = finish;
+            }
+            for (int d = workload->dependentsStart[t]; d < workload->dependentsStart[t + 1]; d++)
+            {
+                const int dependent = workload->dependents[d];
+                if (finish > startAt[dependent])
+                {
+                    startAt[dependent] = finish;
+                }
+                if (--depsLeft[dependent] == 0)
+                {
+                    ready[numReady++] = dependent;
+                }
+            }
+        }
+        if (numVisited < numTasks)
+        {
+            fprintf(stderr, "ERROR: The dependencies of %d tasks form a cycle.\n",
+                    numTasks - numVisited);
+            valid = false;
+        }
+        free(depsLeft);
+        free(ready);
+        free(startAt);
+    }
+    free(depIndices);
+
+    return valid;
+}
+
+Workload* workload_create()
+{
+    Workload* workload = malloc(sizeof(Workload));
+    workload->tasks = NULL;
+    workload->numTasks = 0;
+    linkDependencies(workload, NULL, NULL, 0);
+
+    return workload;
+}
+
+Workload* workload_load(const char* filename)
+{
+    FILE* file = NULL;
+    char* line = NULL;
+    size_t lineSize = 0;
+    int lineNum = 0, capacity = 16, edgeCapacity = 16, numEdges = 0;
+    int id, burst, deadline;
+
+    //PRINT AN ERROR IF THE TASKFILE CAN NOT BE OPENED
+    if ((file = fopen(filename, "r")) == NULL)
+    {
+        perror("ERROR: The task file could not be opened ");
+        return NULL;
+    }
+
+    Workload* workload = malloc(sizeof(Workload));
+    workload->tasks = malloc(sizeof(Task) * capacity);
+    workload->numTasks = 0;
+    workload->numDeps = NULL;
+    workload->dependentsStart = NULL;
+    workload->dependents = NULL;
+    int* depOwners = malloc(sizeof(int) * edgeCapacity);
+    int* depIDs = malloc(sizeof(int) * edgeCapacity);
+    bool valid = true;
+
+    //PARSE EACH LINE INTO A TASK, GROWING THE ARRAY AS NEEDED. EACH LINE IS READ
+    // WHOLE, HOWEVER LONG ITS DEPENDENCY LIST IS
+    while (valid && getline(&line, &lineSize, file) != -1)
+    {
+        lineNum++;
+        //THE DEPENDENCIES, IF ANY, COME AFTER A COLON
+        char* depList = strchr(line, ':');
+        if (depList != NULL)
+        {
+            *depList++ = '\0';
+        }
+        int numParsed = task_parseLine(line, &id, &burst, &deadline);
+        if (numParsed == 0 && depList == NULL)
+        {
+            continue;
+        }
+        if (numParsed < 2)
+        {
+            valid = false;
+        }
+
+        //READ EACH TASK# IN THE DEPENDENCY LIST
+        while (valid && depList != NULL)
+        {
+            char* endPtr;
+            const long depID = strtol(depList, &endPtr, 10);
+            if (endPtr == depList)
+            {
+                //ONLY WHITESPACE MAY FOLLOW THE LAST TASK#
+                while (*endPtr == ' ' || *endPtr == '\t' || *endPtr == '\r' || *endPtr == '\n')
+                {
+                    endPtr++;
+                }
+                valid = *endPtr == '\0';
+                break;
+            }
+            if (numEdges == edgeCapacity)
+            {
+                edgeCapacity *= 2;
+                depOwners = realloc(depOwners, sizeof(int) * edgeCapacity);
+                depIDs = realloc(depIDs, sizeof(int) * edgeCapacity);
+            }
+            depOwners[numEdges] = workload->numTasks;
+            depIDs[numEdges] = (int) depID;
+            numEdges++;
+            depList = endPtr;
+        }
+        if (!valid)
+        {
+            fprintf(stderr, "ERROR: Line %d of the task file is not in the format: "
+                    "task# cpu_burst_length [deadline] [: task# ...]\n", lineNum);
+            break;
+        }
+
+        if (workload->numTasks == capacity)
+        {
+            capacity *= 2;
+            workload->tasks = realloc(workload->tasks, sizeof(Task) * capacity);
+        }
+        task_init(&workload->tasks[workload->numTasks], id, burst, deadline, workload->numTasks);
+        workload->numTasks++;
+    }
+    free(line);
+    fclose(file);
+
+    valid = valid && linkDependencies(workload, depOwners, depIDs, numEdges);
+    free(depOwners);
+    free(depIDs);
+    if (!valid)
+    {
+        workload_free(workload);
+        return NULL;
+    }
+
+    return workload;
+}
+
+void workload_free(Workload* workload)
+{
+    free(workload->tasks);
+    free(workload->numDeps);
+    free(workload->dependentsStart);
+    free(workload->dependents);
+    free(workload);
+}
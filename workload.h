@@ -0,0 +1,92 @@
+/**
+ * @headerfile workload.h
+ * @brief Defines the structure of a Workload, the parsed contents of a task
+ * file, and the functions for loading and destroying said structure.
+ *
+ * A Workload is read once and is then only read from, so a single Workload can
+ * be shared by any number of simulations running at the same time.
+ *  Tasks may depend on other tasks, in which case they may only be run once
+ * every task they depend on has been completed. The dependencies must form a
+ * directed acyclic graph, which is stored as the list of dependents of each
+ * task so that a completed task can find the tasks it releases.
+ *
+ * @author Lachlan Mackenzie
+ * @date 18/10/26
+ */
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "task.h"
+
+//STRUCTS
+/**
+ * @brief This Workload struct is used to store every task read from a task file.
+ *
+ * @field tasks The tasks in the order they appear in the file. Only the id,
+ * burst, deadline and position of each task are set, the times are filled in by a simulation on its
+ * own copy of the task.
+ * @field numTasks The number of tasks in the file.
+ * @field numDeps The number of tasks each task depends on, indexed by the
+ * task's position in the file. A task with none can be run straight away.
+ * @field dependentsStart Where the dependents of each task start in
+ * @c dependents, indexed by the task's position in the file, with one more
+ * entry holding the total.
+ * @field dependents The positions of the tasks that depend on each task, the
+ * dependents of task i being from dependentsStart[i] up to dependentsStart[i + 1].
+ * @field hasDeps True if any task depends on another.
+ * @field criticalPath The longest total burst length of any chain of
+ * dependent tasks, the shortest the workload can take however many CPUs there are.
+ * @field totalBurst The total burst length of every task.
+ */
+typedef struct
+{
+    Task* tasks;
+    int numTasks;
+    int* numDeps;
+    int* dependentsStart;
+    int* dependents;
+    bool hasDeps;
+    long long criticalPath;
+    long long totalBurst;
+} Workload;
+
+//FUNCTION PROTOTYPES
+/**
+ * @brief Creates a Workload with no tasks and allocates memory to it on the heap.
+ *
+ * Used when the tasks are read while the scheduler is running instead.
+ *
+ * @return A pointer to the Workload struct on the heap.
+ */
+Workload* workload_create();
+
+/**
+ * @brief Reads every task in the given file into a Workload and allocates
+ * memory to it on the heap.
+ *
+ * Each line of the file is in the format:
+ * task# cpu_burst_length [deadline] [: task# ...]
+ * where the optional deadline is how long after arriving the task must be
+ * completed by, in the same units as the burst length, and the optional list
+ * after a colon is the tasks that must be completed before this one can run.
+ * Lines can be of any length. Blank lines are skipped. An error is printed to stderr if the file can not
+ * be opened, a line is not in the correct format, a task depends on a task
+ * that is not in the file, or the dependencies form a cycle.
+ *
+ * @param filename The name of the file the tasks are stored in.
+ * @return A pointer to the Workload struct on the heap, or NULL on an error.
+ */
+Workload* workload_load(const char* filename);
+
+/**
+ * @brief Deallocates all memory associated with the specified Workload.
+ *
+ * @param workload The Workload to deallocate from memory.
+ */
+void workload_free(Workload* workload);
+
+#endif